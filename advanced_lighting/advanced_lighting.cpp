@@ -28,7 +28,10 @@ THE SOFTWARE.
 #include <string>
 #include "infrastructure.h"
 #include "shader.h"
-#include "geometry.h"
+#include "mesh.h"
+#include "uniformbuffer.h"
+#include "renderqueue.h"
+#include "ringbuffer.h"
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 
@@ -51,6 +54,17 @@ based from http://renderwonk.com/publications/s2010-shading-course/
 int width = 800;
 int height = 600;
 glm::mat4 projectionMatrix;
+//std140 layout of the DrawData block in ../shaders/drawdata.glsl
+struct MaterialData {
+	glm::vec3 materialColor;
+	float metalness;
+	float roughness;
+};
+struct DrawData {
+	glm::mat4 modelMatrix;
+	MaterialData material;
+	float padding[3];
+};
 void onResize(GLFWwindow* window, int w, int h){
 	width = w;
 	height = h;
@@ -75,68 +89,84 @@ int main(int argc, char* argv[]){
 	//set the clear color to ambient
 	glClearColor(0.1f,0.1f,0.1f,1.0f);
 
-	//compile our shader
-	std::shared_ptr<Shader> lightingShader = Shader::Create("mvpNormals.vert","lighting.frag");
-	if(!lightingShader){
-		//compiling one of the shaders failed
+	//compile our shaders
+	//	metals and dielectrics each get their own lighting program, specialized with a define instead of
+	//	mixing on the metalness in every fragment, and the permutations share the one vertex stage
+	ShaderPermutations permutations;
+	auto vertexShader = permutations.get(GL_VERTEX_SHADER, "../shaders/mvpNormals.vert", ShaderDefines{{"DRAW_DATA", "1"}});
+	std::shared_ptr<Shader> metalShader = Shader::Create(vertexShader,
+		permutations.get(GL_FRAGMENT_SHADER, "lighting.frag", ShaderDefines{{"METALNESS", "1.0"}}));
+	std::shared_ptr<Shader> dielectricShader = Shader::Create(vertexShader,
+		permutations.get(GL_FRAGMENT_SHADER, "lighting.frag", ShaderDefines{{"METALNESS", "0.0"}}));
+	if(!metalShader || !dielectricShader){
+		//loading one of the shaders failed
 		waitForExit(window);
 		return -1;
 	}
-	lightingShader->bindAttrib(0,"in_Position");
-	lightingShader->bindAttrib(1,"in_Normal");
-	lightingShader->bindAttrib(2,"in_TexCoord");
-	if(!lightingShader->link()){
-		printf("linking shader program failed :(");
-		waitForExit(window);
-		return -1;
+	std::shared_ptr<Shader> lightingShaders[] = {metalShader, dielectricShader};
+	for(auto& lightingShader : lightingShaders){
+		lightingShader->bindAttrib(0,"in_Position");
+		lightingShader->bindAttrib(1,"in_Normal");
+		lightingShader->bindAttrib(2,"in_TexCoord");
+		//every program is started before any is waited on, so the driver can compile them side by side
+		lightingShader->linkAsync();
 	}
-	//now to pass in our transform matrices we need to get the location of the uniforms
-	lightingShader->bind();
-	GLint projectionMatrixIndex = glGetUniformLocation(lightingShader->getId(),"projectionMatrix");
-	GLint viewMatrixIndex = glGetUniformLocation(lightingShader->getId(),"viewMatrix");
-	GLint modelMatrixIndex = glGetUniformLocation(lightingShader->getId(),"modelMatrix");
-	GLint cameraIndex = glGetUniformLocation(lightingShader->getId(),"cameraWorldPosition");
-	GLint lightIndex = glGetUniformLocation(lightingShader->getId(),"lightPosition");
-	GLint lightColorIndex = glGetUniformLocation(lightingShader->getId(),"lightColor");
-	GLint materialColorIndex = glGetUniformLocation(lightingShader->getId(),"materialColor");
-	GLint metalnessIndex = glGetUniformLocation(lightingShader->getId(),"metalness");
-	GLint roughnessIndex = glGetUniformLocation(lightingShader->getId(),"roughness");
 
 #ifndef __EMSCRIPTEN__
-	std::shared_ptr<Shader> normalShader = Shader::Create("mvpNormals.vert","attribColor.frag");
+	//geometry shaders are desktop GLSL, and every stage of a program has to be the same version,
+	//	so this program gets its own #version 330 build of the vertex stage
+	std::shared_ptr<Shader> normalShader = Shader::Create(
+		permutations.get(GL_VERTEX_SHADER, "../shaders/mvpNormals.vert", ShaderDefines{{"DRAW_DATA", "1"}, {"#version", "330"}}),
+		permutations.get(GL_FRAGMENT_SHADER, "../shaders/attribColor.frag"));
 	if(!normalShader){
-		//compiling one of the shaders failed
+		//loading one of the shaders failed
 		waitForExit(window);
 		return -1;
 	}
 	//attach a geometry shader
-	auto gs = ShaderStage::Create(GL_GEOMETRY_SHADER);
-	if(!gs->compileFromFile("ssnormals.geom")){
-		printf("Compiling geometry shader failed :(");
+	auto gs = permutations.get(GL_GEOMETRY_SHADER, "../shaders/ssnormals.geom");
+	if(!gs){
+		printf("Loading geometry shader failed :(");
 		waitForExit(window);
 		return -1;
 	}
-	normalShader->attach(std::move(gs));
+	normalShader->attach(gs);
 	normalShader->bindAttrib(0,"in_Position");
 	normalShader->bindAttrib(1,"in_Normal");
 	normalShader->bindAttrib(2,"in_TexCoord");
-	if(!normalShader->link()){
+	normalShader->linkAsync();
+#endif
+
+	for(auto& lightingShader : lightingShaders){
+		if(!lightingShader->finishLink()){
+			printf("linking shader program failed :(");
+			waitForExit(window);
+			return -1;
+		}
+		//the camera and light are the same for every program, they come from one uniform buffer
+		lightingShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+		//the model matrix and material of each draw are streamed through a ring buffer instead of set as uniforms
+		lightingShader->bindUniformBlock("DrawData",DrawDataBinding);
+	}
+#ifndef __EMSCRIPTEN__
+	if(!normalShader->finishLink()){
 		printf("linking shader program failed :(");
 		waitForExit(window);
 		return -1;
 	}
-	//now to pass in our transform matrices we need to get the location of the uniforms
+	normalShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+	normalShader->bindUniformBlock("DrawData",DrawDataBinding);
+	//the normal length never changes, and uniforms stay with the program
 	normalShader->bind();
-	GLint normalProjectionMatrixIndex = glGetUniformLocation(normalShader->getId(),"projectionMatrix");
-	GLint normalViewMatrixIndex = glGetUniformLocation(normalShader->getId(),"viewMatrix");
-	GLint normalModelMatrixIndex = glGetUniformLocation(normalShader->getId(),"modelMatrix");
-	GLint normalLengthIndex = glGetUniformLocation(normalShader->getId(),"normalLength");
-	GLint normalLightIndex = glGetUniformLocation(normalShader->getId(),"lightPosition");
+	normalShader->uniform<GLfloat>("normalLength").set(0.5f);
 #endif
-	Geometry<Plane> bb;
-	IndexedGeometry<SharpCube> bb2;
-	bb.init();
-	bb2.init();
+	std::shared_ptr<UniformBuffer<FrameUniforms>> frameUniforms = UniformBuffer<FrameUniforms>::Create(FrameUniformsBinding);
+	FrameUniforms frame;
+	//room for a few thousand draws a frame, far more than this demo makes
+	std::shared_ptr<RingBuffer> drawRing = RingBuffer::Create(GL_UNIFORM_BUFFER, 1 << 20);
+	//the shapes are built on the CPU and uploaded interleaved, the way the shaders read them
+	std::shared_ptr<MeshBuffers> bb = MeshBuffers::Create(Mesh::FromShape<Plane>(), VertexLayout::Interleaved());
+	std::shared_ptr<MeshBuffers> bb2 = MeshBuffers::Create(Mesh::FromShape<SharpCube>(), VertexLayout::Interleaved());
 	
 	//pick some positions for the camera and a light
 	glm::vec3 cameraPosition = glm::vec3(0.f,2.f,3.f);
@@ -150,6 +180,20 @@ int main(int argc, char* argv[]){
 	glm::mat4 modelMatrixLeft = glm::translate(0.f,0.f,0.f);
 	glm::mat4 modelMatrixRight = glm::translate(0.f,2.f,-4.f);
 
+	//the lit cubes go through a render queue, which sorts the draws so that each material is only set once
+	RenderQueue queue;
+	queue.streamDrawData(drawRing.get(), DrawDataBinding);
+	Material gold;
+	gold.setDrawData(MaterialData{
+		glm::vec3(1.0f, 0.766f, 0.336f),//gold specular color
+		1.0f,//metal
+		0.1f});//rough
+	Material plastic;
+	plastic.setDrawData(MaterialData{
+		glm::vec3(0.14f, 0.54f, 0.96f),//blue plastic
+		0.f,//not a metal
+		0.8f});//smooth
+
 	//enable depth test so that the front of the cube will occlude the back of the cube
 	glEnable(GL_DEPTH_TEST);
 
@@ -157,6 +201,13 @@ int main(int argc, char* argv[]){
 	auto main_loop = [=]() mutable {
 		//first poll for events
 		glfwPollEvents();
+		//picks up edits to the shader files
+		for(auto& lightingShader : lightingShaders){
+			lightingShader->reload();
+		}
+#ifndef __EMSCRIPTEN__
+		normalShader->reload();
+#endif
 
 		//let's make our cubes spin
 		modelMatrixLeft = glm::rotate(modelMatrixLeft,0.5f,glm::vec3(0.f,1.f,0.f));
@@ -169,39 +220,38 @@ int main(int argc, char* argv[]){
 
 		//clear the screen
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		//only waits if the GPU is still reading what was written three frames ago
+		drawRing->beginFrame();
 
-		lightingShader->bind();
-		glUniformMatrix4fv(projectionMatrixIndex, 1, false, glm::value_ptr(projectionMatrix));
-		glUniformMatrix4fv(viewMatrixIndex, 1, false, glm::value_ptr(viewMatrix));
-		//glUniformMatrix4fv(modelMatrixIndex,1,false,glm::value_ptr(modelMatrix));
-		glUniform3f(cameraIndex, cameraPosition.x, cameraPosition.y, cameraPosition.z);
-		glUniform3f(lightIndex, lightPosition.x, lightPosition.y, lightPosition.z);
-		glUniform3f(lightColorIndex, lightColor.r, lightColor.g, lightColor.b);
+		//one upload for both programs
+		frame.projectionMatrix = projectionMatrix;
+		frame.viewMatrix = viewMatrix;
+		frame.cameraWorldPosition = cameraPosition;
+		frame.lightPosition = lightPosition;
+		frame.lightColor = lightColor;
+		frameUniforms->update(frame);
+
+#ifndef __EMSCRIPTEN__
+		//written before the queue runs so that its flush covers this as well
+		DrawData normalDrawData = {};
+		normalDrawData.modelMatrix = modelMatrixLeft;
+		GLintptr normalDrawDataOffset = drawRing->push(normalDrawData);
+#endif
 		//bb.draw();
-		//glUniform3f(materialColorIndex,0.972f,0.96f,0.915f);//silver specular color
-		glUniform3f(materialColorIndex, 1.0f, 0.766f, 0.336f);//gold specular color
-		glUniform1f(metalnessIndex, 1.0f);//metal
-		glUniform1f(roughnessIndex, 0.1f);//rough
-		glUniformMatrix4fv(modelMatrixIndex, 1, false, glm::value_ptr(modelMatrixLeft));
-		bb2.draw();
-		glUniform3f(materialColorIndex, 0.14f, 0.54f, 0.96f); //blue plastic
-		glUniform1f(metalnessIndex, 0.f);//not a metal
-		glUniform1f(roughnessIndex, 0.8f);//smooth
-		glUniformMatrix4fv(modelMatrixIndex, 1, false, glm::value_ptr(modelMatrixRight));
-		bb2.draw();
+		//silver specular color would be glm::vec3(0.972f,0.96f,0.915f)
+		queue.submit(*metalShader, gold, bb2->getDrawCall(), modelMatrixLeft);
+		queue.submit(*dielectricShader, plastic, bb2->getDrawCall(), modelMatrixRight);
+		queue.execute();
 #ifndef __EMSCRIPTEN__
 		normalShader->bind();
-		glUniformMatrix4fv(normalProjectionMatrixIndex, 1, false, glm::value_ptr(projectionMatrix));
-		glUniformMatrix4fv(normalViewMatrixIndex, 1, false, glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(normalModelMatrixIndex, 1, false, glm::value_ptr(modelMatrixLeft));
-		glUniform1f(normalLengthIndex, 0.5f);
-		glUniform3f(normalLightIndex, lightPosition.x, lightPosition.y, lightPosition.z);
+		drawRing->bindRange(DrawDataBinding, normalDrawDataOffset, sizeof(DrawData));
 #endif
-		bb.draw();
-		bb2.draw();
+		bb->draw();
+		bb2->draw();
+		drawRing->endFrame();
 
 		//finally, update the screen
-		glfwSwapBuffers(window);
+		swapBuffers(window);
 	};
 
 	//Main rendering loop
@@ -1,10 +0,0 @@
-#version 300 es
-
-precision highp float;
-
-in vec4 color;
-out vec4 FragColor;
-
-void main(){
-	FragColor = color;
-}
\ No newline at end of file
@@ -8,12 +8,15 @@ in vec3 vs_LightVector;
 in vec3 vs_WorldPosition;
 in float vs_LightDistance;
 
-uniform vec3 lightPosition;
-uniform vec3 lightColor;
-uniform vec3 cameraWorldPosition;
-uniform vec3 materialColor;
-uniform float roughness;
-uniform float metalness;
+#include "framedata.glsl"
+
+#include "drawdata.glsl"
+
+//the metal and dielectric programs define METALNESS as 1.0 or 0.0 (see advanced_lighting.cpp),
+//  which folds the mixes in main away, otherwise it comes from the material
+#ifndef METALNESS
+#define METALNESS metalness
+#endif
 
 out vec4 fragColor;
 
@@ -97,9 +100,9 @@ void main(void){
     float lightDistance = length(lightdiff);
     vec3 eyeDirection = normalize(cameraWorldPosition - vs_WorldPosition);
     //calculate lambertian diffuse term, metals have no diffuse
-    vec3 diffuse = mix(materialColor.rgb,vec3(0.0),metalness);
+    vec3 diffuse = mix(materialColor.rgb,vec3(0.0),METALNESS);
     //calculate specular color, 0.004 is a good enough specular for all dielectrics
-    vec3 specColor = mix(vec3(0.04),materialColor.rgb,metalness);
+    vec3 specColor = mix(vec3(0.04),materialColor.rgb,METALNESS);
     float mappedRough = calcRoughness(100000.0,roughness);
     //diffuse = diffuse / materialData.a;
     //calculate blinn-phong specular term
@@ -0,0 +1,330 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "infrastructure.h"
+#include "shader.h"
+#include "geometry.h"
+#include "mesh.h"
+#include "uniformbuffer.h"
+#include "renderqueue.h"
+#include "commandlist.h"
+#include "meshregistry.h"
+#include "workerpool.h"
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+
+void RenderLoopCallback(void* arg) {
+	(*static_cast<std::function<void()>*>(arg))();
+}
+
+#endif
+
+/*
+OpenGL Cube Field
+*************************
+This demo draws a large grid of spinning cubes, one draw call each.
+Every frame the cubes' matrices are worked out on all cores, recorded into one command list per thread,
+and the lists are sorted and drawn from the main thread, which is the only one allowed to call OpenGL.
+With --instanced the matrices are written into an instance buffer instead and every cube is drawn
+by a single glDrawElementsInstanced.
+With --multidraw cubes, planes and billboards are packed into one MeshRegistry and the whole field is drawn
+by a single glMultiDrawElementsIndirect, the shader finding each object's matrix with gl_DrawIDARB (needs OpenGL 4.3).
+With --prepass the one draw per cube mode first draws every cube's depth from a position only vertex buffer
+with a trivial shader, then shades with depth func GL_EQUAL, so lighting.frag runs once per visible pixel.
+
+The grid is 64x64 cubes, pass a different side length as the first argument.
+Run it with DEMO_GL_BACKEND=recording to see how many calls a frame takes without the GPU in the way.
+*/
+
+int width = 800;
+int height = 600;
+glm::mat4 projectionMatrix;
+void onResize(GLFWwindow* window, int w, int h){
+	width = w;
+	height = h;
+	//calculate an updated perspective projection matrix
+	projectionMatrix = glm::perspective(60.f,float(w)/float(h),0.1f,200.f);
+	//tell OpenGL to make our viewport match the window size
+	glViewport(0,0,w,h);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glfwSwapBuffers(window);
+}
+int main(int argc, char* argv[]){
+	int side = 64;
+	bool instanced = false;
+	bool multidraw = false;
+	bool prepass = false;
+	for(int i=1;i<argc;i++){
+		if(std::string(argv[i]) == "--instanced"){
+			instanced = true;
+		} else if(std::string(argv[i]) == "--multidraw"){
+			multidraw = true;
+		} else if(std::string(argv[i]) == "--prepass"){
+			prepass = true;
+		} else {
+			side = atoi(argv[i]);
+		}
+	}
+	//Create an OpenGL window and set up a context with proper debug output
+	GLFWwindow* window = init(800,600,"Cube Field");
+	if(window == nullptr){
+		//initialization failed
+		return -1;
+	}
+	//add a callback so we know when the window is resized
+	glfwSetFramebufferSizeCallback(window,onResize);
+
+	glClearColor(0.1f,0.1f,0.1f,1.0f);
+
+	std::shared_ptr<Shader> lightingShader;
+	if(multidraw){
+		lightingShader = Shader::Create("multidraw.vert","multidraw.frag");
+	} else if(instanced){
+		lightingShader = Shader::Create("instanced.vert","instanced.frag");
+	} else {
+		lightingShader = Shader::Create("../shaders/mvpNormals.vert","lighting.frag");
+	}
+	if(!lightingShader){
+		waitForExit(window);
+		return -1;
+	}
+	lightingShader->bindAttrib(0,"in_Position");
+	lightingShader->bindAttrib(1,"in_Normal");
+	lightingShader->bindAttrib(2,"in_TexCoord");
+	if(instanced){
+		//the matrix takes locations 3 to 6
+		lightingShader->bindAttrib(3,"in_ModelMatrix");
+		lightingShader->bindAttrib(7,"in_Material");
+	}
+	if(!lightingShader->link()){
+		printf("linking shader program failed :(");
+		waitForExit(window);
+		return -1;
+	}
+	lightingShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+	if(prepass && (multidraw || instanced)){
+		printf("--prepass only works with one draw per cube\n");
+		prepass = false;
+	}
+	std::shared_ptr<Shader> depthShader;
+	if(prepass){
+		depthShader = Shader::Create("depth.vert","depth.frag");
+		if(!depthShader){
+			waitForExit(window);
+			return -1;
+		}
+		depthShader->bindAttrib(0,"in_Position");
+		if(!depthShader->link()){
+			printf("linking shader program failed :(");
+			waitForExit(window);
+			return -1;
+		}
+		depthShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+	}
+	lightingShader->bind();
+	GLint materialColorIndex = lightingShader->getUniformLocation("materialColor");
+
+	//a handful of materials so the queue has something to sort by
+	const int materialCount = 4;
+	const glm::vec3 materialColors[materialCount] = {
+		glm::vec3(0.9f, 0.2f, 0.2f), glm::vec3(0.2f, 0.9f, 0.2f), glm::vec3(0.2f, 0.2f, 0.9f), glm::vec3(0.9f, 0.9f, 0.9f)
+	};
+	Material materials[materialCount];
+	for(int i=0;i<materialCount;i++){
+		materials[i].set(materialColorIndex, materialColors[i]);
+	}
+
+	size_t cubeCount = size_t(side * side);
+	std::shared_ptr<MeshBuffers> cube;
+	//the same cube with nothing but packed positions, 12 bytes a vertex instead of 32
+	std::shared_ptr<MeshBuffers> cubeDepth;
+	std::shared_ptr<InstancedGeometry<SharpCube>> cubes;
+	std::shared_ptr<MeshRegistry> meshes;
+	std::shared_ptr<MultiDrawBatch> batch;
+	MeshHandle meshHandles[3];
+	if(multidraw){
+		batch = MultiDrawBatch::Create();
+		if(!batch){
+			waitForExit(window);
+			return -1;
+		}
+		meshes = MeshRegistry::Create();
+		meshHandles[0] = meshes->add<SharpCube>();
+		meshHandles[1] = meshes->add<Plane>();
+		meshHandles[2] = meshes->add<Billboard>();
+		meshes->upload();
+		batch->resize(cubeCount);
+		VertexCacheStats before, after;
+		meshes->getVertexCacheStats(&before, &after);
+		printf("vertex cache: ACMR %.2f -> %.2f, ATVR %.2f -> %.2f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+	} else if(instanced){
+		cubes = std::make_shared<InstancedGeometry<SharpCube>>();
+		cubes->init(cubeCount);
+	} else {
+		Mesh mesh = Mesh::FromShape<SharpCube>();
+		cube = MeshBuffers::Create(mesh, VertexLayout::Interleaved());
+		VertexCacheStats before, after;
+		if(cube->getVertexCacheStats(&before, &after)){
+			printf("vertex cache: ACMR %.2f -> %.2f, ATVR %.2f -> %.2f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+		}
+		if(prepass){
+			cubeDepth = MeshBuffers::Create(mesh, VertexLayout().add(PositionAttribute, VertexFormat::Float3));
+		}
+	}
+	std::vector<InstanceData> instances(instanced ? cubeCount : 0);
+
+	glm::vec3 cameraPosition = glm::vec3(0.f, float(side), float(side));
+	glm::vec3 lightPosition = glm::vec3(0.f, 0.5f * float(side), 0.f);
+	glm::vec3 lightColor = float(side * side) * glm::vec3(0.5f);
+	glm::mat4 viewMatrix = glm::lookAt(cameraPosition,glm::vec3(0.f),glm::vec3(0.f,1.f,0.f));
+	float farthest = 2.f * glm::length(cameraPosition);
+	std::shared_ptr<UniformBuffer<FrameUniforms>> frameUniforms = UniformBuffer<FrameUniforms>::Create(FrameUniformsBinding);
+	FrameUniforms frame;
+	frame.viewMatrix = viewMatrix;
+	frame.cameraWorldPosition = cameraPosition;
+	frame.lightPosition = lightPosition;
+	frame.lightColor = lightColor;
+
+	glEnable(GL_DEPTH_TEST);
+
+	//the pool, recorder and queue keep their threads and memory from frame to frame
+	std::shared_ptr<WorkerPool> pool = std::make_shared<WorkerPool>();
+	std::shared_ptr<ParallelCommandRecorder> recorder = std::make_shared<ParallelCommandRecorder>(*pool);
+	std::shared_ptr<RenderQueue> queue = std::make_shared<RenderQueue>();
+	//the prepass draws are layer 0 and only write depth, the shading draws in layer 1 only pass where they made it
+	//	Nothing but the cube's positions and matrices go into layer 0, so it has no material values.
+	Material depthOnly;
+	if(prepass){
+		queue->setLayerState(0, []{
+			glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
+			glDepthMask(GL_TRUE);
+			glDepthFunc(GL_LESS);
+		});
+		queue->setLayerState(1, []{
+			glColorMask(GL_TRUE,GL_TRUE,GL_TRUE,GL_TRUE);
+			glDepthMask(GL_FALSE);
+			glDepthFunc(GL_EQUAL);
+		});
+	}
+	printf("%d cubes on %u threads%s%s\n", side * side, pool->getWorkerCount(), multidraw ? ", multi draw indirect" : instanced ? ", instanced" : "", prepass ? ", depth prepass" : "");
+
+	float angle = 0.f;
+	auto main_loop = [=]() mutable {
+		glfwPollEvents();
+		angle += 0.5f;
+		//picks up edits to the shader files, materials hold locations so they are set again for the new program
+		if(depthShader){
+			depthShader->reload();
+		}
+		if(lightingShader->reload()){
+			for(int i=0;i<materialCount;i++){
+				materials[i] = Material();
+				materials[i].set(lightingShader->getUniformLocation("materialColor"), materialColors[i]);
+			}
+		}
+
+		auto position = [=](size_t index){
+			int x = int(index) % side;
+			int z = int(index) / side;
+			return glm::vec3(2.f * float(x - side / 2), 0.f, 2.f * float(z - side / 2));
+		};
+		auto modelMatrix = [=](size_t index, glm::vec3 position){
+			glm::mat4 modelMatrix = glm::translate(position);
+			modelMatrix = glm::rotate(modelMatrix, angle + float(index), glm::vec3(0.f,1.f,0.f));
+			return glm::scale(modelMatrix, glm::vec3(0.5f));
+		};
+		//building the frame doesn't touch OpenGL, so it is spread over every core
+		if(multidraw){
+			pool->parallelFor(cubeCount, [&](unsigned int, size_t begin, size_t end){
+				for(size_t i=begin;i<end;i++){
+					InstanceData data;
+					data.modelMatrix = modelMatrix(i, position(i));
+					data.material = glm::vec4(materialColors[i % materialCount], 0.f);
+					batch->set(i, meshHandles[i % 3], data);
+				}
+			});
+		} else if(instanced){
+			pool->parallelFor(cubeCount, [&](unsigned int, size_t begin, size_t end){
+				for(size_t i=begin;i<end;i++){
+					instances[i].modelMatrix = modelMatrix(i, position(i));
+					instances[i].material = glm::vec4(materialColors[i % materialCount], 0.f);
+				}
+			});
+		} else {
+			Shader& shader = *lightingShader;
+			DrawCall mesh = cube->getDrawCall();
+			DrawCall depthMesh = prepass ? cubeDepth->getDrawCall() : DrawCall();
+			recorder->record(cubeCount, [&](CommandList& list, size_t index){
+				glm::vec3 p = position(index);
+				float depth = glm::length(p - cameraPosition) / farthest;
+				glm::mat4 transform = modelMatrix(index, p);
+				if(prepass){
+					list.draw(*depthShader, depthOnly, depthMesh, transform, 0, depth);
+				}
+				list.draw(shader, materials[index % materialCount], mesh, transform, prepass ? 1 : 0, depth);
+			});
+		}
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		//the projection changes with the window size, everything else in the block is fixed
+		frame.projectionMatrix = projectionMatrix;
+		frameUniforms->update(frame);
+		lightingShader->bind();
+		//only the context thread talks to OpenGL
+		if(multidraw){
+			batch->draw(*meshes);
+		} else if(instanced){
+			cubes->update(0, instances.data(), instances.size());
+			cubes->draw();
+		} else {
+			recorder->replay(*queue);
+			queue->execute();
+			if(prepass){
+				//glClear only clears depth while it can be written
+				glDepthMask(GL_TRUE);
+				glDepthFunc(GL_LESS);
+			}
+		}
+
+		swapBuffers(window);
+	};
+
+	//Main rendering loop
+#ifdef __EMSCRIPTEN__
+	emscripten_set_main_loop_arg(&RenderLoopCallback,new std::function<void()>(main_loop), -1, false);
+	onResize(window, width, height); //and call it once to set initial values
+#else
+	onResize(window, width, height); //and call it once to set initial values
+	while(!glfwWindowShouldClose(window)){
+		main_loop();
+	}
+#endif
+	return 0;
+}
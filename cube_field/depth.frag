@@ -0,0 +1,10 @@
+#version 300 es
+
+precision mediump float;
+
+//color writes are off during the depth prepass, this only has to exist
+out vec4 fragColor;
+
+void main(void){
+    fragColor = vec4(0.0);
+}
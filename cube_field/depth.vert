@@ -0,0 +1,16 @@
+#version 300 es
+
+//positions only, for the depth prepass
+in vec3 in_Position;
+
+uniform mat4 modelMatrix;
+#include "framedata.glsl"
+
+//the shading pass tests GL_EQUAL against this depth, so the position has to come out
+//  bit for bit the same as in ../shaders/mvpNormals.vert: same math in the same order, and invariant
+invariant gl_Position;
+
+void main(void){
+    vec4 worldPosition = modelMatrix * vec4(in_Position,1.0);
+    gl_Position = projectionMatrix * viewMatrix * worldPosition;
+}
@@ -0,0 +1 @@
+ sh ../infrastructure/embed-shaders.sh embeddedshaders.gen.cpp *.vert *.frag *.geom *.glsl ../shaders/*.vert ../shaders/*.glsl && em++ -std=c++14 -I ../infrastructure ../infrastructure/*.cpp cube_field.cpp embeddedshaders.gen.cpp -o cube_field.html -lGLEW -s USE_GLFW=3 -s ERROR_ON_UNDEFINED_SYMBOLS=0 -s USE_WEBGL2=1 -g4 --source-map-base http://localhost:6931/
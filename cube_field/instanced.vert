@@ -3,20 +3,21 @@
 in vec3 in_Position;
 in vec3 in_Normal;
 in vec2 in_TexCoord;
+in mat4 in_ModelMatrix;
+in vec4 in_Material;
 
 out vec3 vs_WorldPosition;
 out vec3 vs_WorldNormal;
 out vec3 vs_EyeVector;
 out vec3 vs_LightVector;
 out float vs_LightDistance;
+out vec3 vs_MaterialColor;
 
-uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
-uniform vec3 cameraWorldPosition;
-uniform vec3 lightPosition;
+#include "framedata.glsl"
 
 void main(void){
+    mat4 modelMatrix = in_ModelMatrix;
+    vs_MaterialColor = in_Material.rgb;
     mat4 normalMatrix = transpose(inverse(modelMatrix));
     vs_WorldNormal = normalize(normalMatrix * vec4(in_Normal,0.0)).xyz;
     vec4 worldPosition = modelMatrix * vec4(in_Position,1.0);
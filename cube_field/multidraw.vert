@@ -0,0 +1,37 @@
+#version 430
+#extension GL_ARB_shader_draw_parameters : require
+
+in vec3 in_Position;
+in vec3 in_Normal;
+in vec2 in_TexCoord;
+
+out vec3 vs_WorldPosition;
+out vec3 vs_WorldNormal;
+out vec3 vs_EyeVector;
+out vec3 vs_LightVector;
+out float vs_LightDistance;
+out vec3 vs_MaterialColor;
+
+//one entry per draw of the glMultiDrawElementsIndirect, see MultiDrawBatch
+struct InstanceData {
+    mat4 modelMatrix;
+    vec4 material;
+};
+layout(std430, binding = 0) readonly buffer DrawData {
+    InstanceData draws[];
+};
+
+#include "framedata.glsl"
+
+void main(void){
+    mat4 modelMatrix = draws[gl_DrawIDARB].modelMatrix;
+    vs_MaterialColor = draws[gl_DrawIDARB].material.rgb;
+    mat4 normalMatrix = transpose(inverse(modelMatrix));
+    vs_WorldNormal = normalize(normalMatrix * vec4(in_Normal,0.0)).xyz;
+    vec4 worldPosition = modelMatrix * vec4(in_Position,1.0);
+    vs_WorldPosition = worldPosition.xyz;
+    vs_EyeVector = normalize(cameraWorldPosition - worldPosition.xyz);
+    vs_LightVector = normalize(lightPosition - worldPosition.xyz);
+    vs_LightDistance = length(lightPosition - worldPosition.xyz);
+    gl_Position = projectionMatrix * viewMatrix * worldPosition;
+}
\ No newline at end of file
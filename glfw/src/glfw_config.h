@@ -37,20 +37,30 @@
 // Define this to 1 if building GLFW for X11
 /* #undef _GLFW_X11 */
 // Define this to 1 if building GLFW for Win32
-#define _GLFW_WIN32
+#if defined(_WIN32)
+ #define _GLFW_WIN32
+#endif
 // Define this to 1 if building GLFW for Cocoa
 /* #undef _GLFW_COCOA */
 // Define this to 1 if building GLFW for Wayland
 /* #undef _GLFW_WAYLAND */
 // Define this to 1 if building GLFW for Mir
 /* #undef _GLFW_MIR */
+// Define this to 1 if building GLFW without any window system (offscreen)
+#if !defined(_WIN32)
+ #define _GLFW_NULL
+#endif
 
 // Define this to 1 if building GLFW for EGL
-/* #undef _GLFW_EGL */
+#if defined(_GLFW_NULL)
+ #define _GLFW_EGL
+#endif
 // Define this to 1 if building GLFW for GLX
 /* #undef _GLFW_GLX */
 // Define this to 1 if building GLFW for WGL
-#define _GLFW_WGL
+#if defined(_GLFW_WIN32)
+ #define _GLFW_WGL
+#endif
 // Define this to 1 if building GLFW for NSGL
 /* #undef _GLFW_NSGL */
 
@@ -58,7 +68,9 @@
 /* #undef _GLFW_BUILD_DLL */
 
 // Define this to 1 if glfwSwapInterval should ignore DWM compositing status
-#define _GLFW_USE_DWM_SWAP_INTERVAL
+#if defined(_GLFW_WIN32)
+ #define _GLFW_USE_DWM_SWAP_INTERVAL
+#endif
 // Define this to 1 to force use of high-performance GPU on Optimus systems
 /* #undef _GLFW_USE_OPTIMUS_HPG */
 
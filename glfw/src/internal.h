@@ -87,6 +87,8 @@ typedef struct _GLFWcursor      _GLFWcursor;
  #include "wl_platform.h"
 #elif defined(_GLFW_MIR)
  #include "mir_platform.h"
+#elif defined(_GLFW_NULL)
+ #include "null_platform.h"
 #else
  #error "No supported window creation API selected"
 #endif
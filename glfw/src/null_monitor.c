@@ -0,0 +1,108 @@
+//========================================================================
+// GLFW 3.1 Null - www.glfw.org
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The single virtual monitor reported to the shared code
+//
+#define _GLFW_NULL_MONITOR_WIDTH   1920
+#define _GLFW_NULL_MONITOR_HEIGHT  1080
+#define _GLFW_NULL_MONITOR_REFRESH 60
+
+
+//////////////////////////////////////////////////////////////////////////
+//////                       GLFW platform API                      //////
+//////////////////////////////////////////////////////////////////////////
+
+_GLFWmonitor** _glfwPlatformGetMonitors(int* count)
+{
+    _GLFWmonitor** monitors = calloc(1, sizeof(_GLFWmonitor*));
+
+    // Pretend to be a 96 dpi display
+    monitors[0] = _glfwAllocMonitor("Null",
+                                    _GLFW_NULL_MONITOR_WIDTH * 25.4f / 96.f,
+                                    _GLFW_NULL_MONITOR_HEIGHT * 25.4f / 96.f);
+
+    monitors[0]->null.mode.width = _GLFW_NULL_MONITOR_WIDTH;
+    monitors[0]->null.mode.height = _GLFW_NULL_MONITOR_HEIGHT;
+    monitors[0]->null.mode.redBits = 8;
+    monitors[0]->null.mode.greenBits = 8;
+    monitors[0]->null.mode.blueBits = 8;
+    monitors[0]->null.mode.refreshRate = _GLFW_NULL_MONITOR_REFRESH;
+
+    *count = 1;
+    return monitors;
+}
+
+GLboolean _glfwPlatformIsSameMonitor(_GLFWmonitor* first, _GLFWmonitor* second)
+{
+    return strcmp(first->name, second->name) == 0;
+}
+
+void _glfwPlatformGetMonitorPos(_GLFWmonitor* monitor, int* xpos, int* ypos)
+{
+    if (xpos)
+        *xpos = 0;
+    if (ypos)
+        *ypos = 0;
+}
+
+GLFWvidmode* _glfwPlatformGetVideoModes(_GLFWmonitor* monitor, int* count)
+{
+    GLFWvidmode* result = calloc(1, sizeof(GLFWvidmode));
+    *result = monitor->null.mode;
+    *count = 1;
+    return result;
+}
+
+void _glfwPlatformGetVideoMode(_GLFWmonitor* monitor, GLFWvidmode* mode)
+{
+    *mode = monitor->null.mode;
+}
+
+void _glfwPlatformGetGammaRamp(_GLFWmonitor* monitor, GLFWgammaramp* ramp)
+{
+    unsigned int i;
+
+    _glfwAllocGammaArrays(ramp, 256);
+
+    for (i = 0;  i < 256;  i++)
+    {
+        const unsigned short value = (unsigned short) (i * 65535 / 255);
+        ramp->red[i] = value;
+        ramp->green[i] = value;
+        ramp->blue[i] = value;
+    }
+}
+
+void _glfwPlatformSetGammaRamp(_GLFWmonitor* monitor, const GLFWgammaramp* ramp)
+{
+}
+
@@ -0,0 +1,98 @@
+//========================================================================
+// GLFW 3.1 Null - www.glfw.org
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+#ifndef _null_platform_h_
+#define _null_platform_h_
+
+#include "posix_time.h"
+#include "posix_tls.h"
+
+#if defined(_GLFW_EGL)
+ #include "egl_context.h"
+#else
+ #error "The null platform requires the EGL context API"
+#endif
+
+#define _GLFW_PLATFORM_WINDOW_STATE         _GLFWwindowNull   null
+#define _GLFW_PLATFORM_LIBRARY_WINDOW_STATE _GLFWlibraryNull  null
+#define _GLFW_PLATFORM_MONITOR_STATE        _GLFWmonitorNull  null
+#define _GLFW_PLATFORM_CURSOR_STATE         _GLFWcursorNull   null
+#define _GLFW_PLATFORM_LIBRARY_JOYSTICK_STATE int null_js
+
+#define _GLFW_RECREATION_NOT_NEEDED 0
+#define _GLFW_RECREATION_REQUIRED   1
+#define _GLFW_RECREATION_IMPOSSIBLE 2
+
+
+// Null-specific per-window data
+//
+// There is no native window, the size is only remembered so it can be
+// reported back and used for the offscreen surface
+//
+typedef struct _GLFWwindowNull
+{
+    int             width;
+    int             height;
+    int             xpos;
+    int             ypos;
+    GLboolean       visible;
+    GLboolean       iconified;
+
+} _GLFWwindowNull;
+
+
+// Null-specific global data
+//
+typedef struct _GLFWlibraryNull
+{
+    char*           clipboardString;
+
+} _GLFWlibraryNull;
+
+
+// Null-specific per-monitor data
+//
+typedef struct _GLFWmonitorNull
+{
+    GLFWvidmode     mode;
+
+} _GLFWmonitorNull;
+
+
+// Null-specific per-cursor data
+//
+typedef struct _GLFWcursorNull
+{
+    int             dummy;
+
+} _GLFWcursorNull;
+
+
+void _glfwInitJoysticks(void);
+void _glfwTerminateJoysticks(void);
+
+#endif // _null_platform_h_
@@ -0,0 +1,263 @@
+//========================================================================
+// GLFW 3.1 Null - www.glfw.org
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+//////                       GLFW platform API                      //////
+//////////////////////////////////////////////////////////////////////////
+
+int _glfwPlatformCreateWindow(_GLFWwindow* window,
+                              const _GLFWwndconfig* wndconfig,
+                              const _GLFWctxconfig* ctxconfig,
+                              const _GLFWfbconfig* fbconfig)
+{
+    if (wndconfig->monitor)
+    {
+        GLFWvidmode mode;
+        _glfwPlatformGetVideoMode(wndconfig->monitor, &mode);
+
+        window->null.width = mode.width;
+        window->null.height = mode.height;
+    }
+    else
+    {
+        window->null.width = wndconfig->width;
+        window->null.height = wndconfig->height;
+    }
+
+    window->null.visible = wndconfig->visible;
+
+    if (_glfwAnalyzeContext(window, ctxconfig, fbconfig) ==
+        _GLFW_RECREATION_IMPOSSIBLE)
+    {
+        return GL_FALSE;
+    }
+
+    if (!_glfwCreateContext(window, ctxconfig, fbconfig))
+        return GL_FALSE;
+
+    return GL_TRUE;
+}
+
+void _glfwPlatformDestroyWindow(_GLFWwindow* window)
+{
+    _glfwDestroyContext(window);
+}
+
+void _glfwPlatformSetWindowTitle(_GLFWwindow* window, const char* title)
+{
+}
+
+void _glfwPlatformGetWindowPos(_GLFWwindow* window, int* xpos, int* ypos)
+{
+    if (xpos)
+        *xpos = window->null.xpos;
+    if (ypos)
+        *ypos = window->null.ypos;
+}
+
+void _glfwPlatformSetWindowPos(_GLFWwindow* window, int xpos, int ypos)
+{
+    if (window->monitor)
+        return;
+
+    if (window->null.xpos != xpos || window->null.ypos != ypos)
+    {
+        window->null.xpos = xpos;
+        window->null.ypos = ypos;
+        _glfwInputWindowPos(window, xpos, ypos);
+    }
+}
+
+void _glfwPlatformGetWindowSize(_GLFWwindow* window, int* width, int* height)
+{
+    if (width)
+        *width = window->null.width;
+    if (height)
+        *height = window->null.height;
+}
+
+void _glfwPlatformSetWindowSize(_GLFWwindow* window, int width, int height)
+{
+    if (window->monitor)
+        return;
+
+    if (window->null.width == width && window->null.height == height)
+        return;
+
+    if (!_glfwResizeContextSurface(window, width, height))
+        return;
+
+    window->null.width = width;
+    window->null.height = height;
+    _glfwInputWindowSize(window, width, height);
+    _glfwInputFramebufferSize(window, width, height);
+}
+
+void _glfwPlatformGetFramebufferSize(_GLFWwindow* window, int* width, int* height)
+{
+    _glfwPlatformGetWindowSize(window, width, height);
+}
+
+void _glfwPlatformGetWindowFrameSize(_GLFWwindow* window,
+                                     int* left, int* top,
+                                     int* right, int* bottom)
+{
+    if (left)
+        *left = 0;
+    if (top)
+        *top = 0;
+    if (right)
+        *right = 0;
+    if (bottom)
+        *bottom = 0;
+}
+
+void _glfwPlatformIconifyWindow(_GLFWwindow* window)
+{
+    if (!window->null.iconified)
+    {
+        window->null.iconified = GL_TRUE;
+        _glfwInputWindowIconify(window, GL_TRUE);
+    }
+}
+
+void _glfwPlatformRestoreWindow(_GLFWwindow* window)
+{
+    if (window->null.iconified)
+    {
+        window->null.iconified = GL_FALSE;
+        _glfwInputWindowIconify(window, GL_FALSE);
+    }
+}
+
+void _glfwPlatformShowWindow(_GLFWwindow* window)
+{
+    window->null.visible = GL_TRUE;
+}
+
+void _glfwPlatformUnhideWindow(_GLFWwindow* window)
+{
+    window->null.visible = GL_TRUE;
+}
+
+void _glfwPlatformHideWindow(_GLFWwindow* window)
+{
+    window->null.visible = GL_FALSE;
+}
+
+int _glfwPlatformWindowFocused(_GLFWwindow* window)
+{
+    return _glfw.focusedWindow == window;
+}
+
+int _glfwPlatformWindowIconified(_GLFWwindow* window)
+{
+    return window->null.iconified;
+}
+
+int _glfwPlatformWindowVisible(_GLFWwindow* window)
+{
+    return window->null.visible;
+}
+
+void _glfwPlatformPollEvents(void)
+{
+    // There is no event source, input only changes through the public API
+}
+
+void _glfwPlatformWaitEvents(void)
+{
+    // Nothing would ever wake us up, so behave like polling instead
+    _glfwPlatformPollEvents();
+}
+
+void _glfwPlatformPostEmptyEvent(void)
+{
+}
+
+void _glfwPlatformGetCursorPos(_GLFWwindow* window, double* xpos, double* ypos)
+{
+    if (xpos)
+        *xpos = window->cursorPosX;
+    if (ypos)
+        *ypos = window->cursorPosY;
+}
+
+void _glfwPlatformSetCursorPos(_GLFWwindow* window, double xpos, double ypos)
+{
+    window->cursorPosX = xpos;
+    window->cursorPosY = ypos;
+}
+
+void _glfwPlatformApplyCursorMode(_GLFWwindow* window)
+{
+}
+
+int _glfwPlatformCreateCursor(_GLFWcursor* cursor,
+                              const GLFWimage* image,
+                              int xhot, int yhot)
+{
+    return GL_TRUE;
+}
+
+int _glfwPlatformCreateStandardCursor(_GLFWcursor* cursor, int shape)
+{
+    return GL_TRUE;
+}
+
+void _glfwPlatformDestroyCursor(_GLFWcursor* cursor)
+{
+}
+
+void _glfwPlatformSetCursor(_GLFWwindow* window, _GLFWcursor* cursor)
+{
+}
+
+void _glfwPlatformSetClipboardString(_GLFWwindow* window, const char* string)
+{
+    free(_glfw.null.clipboardString);
+    _glfw.null.clipboardString = strdup(string);
+}
+
+const char* _glfwPlatformGetClipboardString(_GLFWwindow* window)
+{
+    if (!_glfw.null.clipboardString)
+    {
+        _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                        "Null: Clipboard is empty");
+        return NULL;
+    }
+
+    return _glfw.null.clipboardString;
+}
+
@@ -0,0 +1,84 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "infrastructure.h"
+#include "gltrace.h"
+#include "glstatecache.h"
+
+/*
+GL Trace Replay
+*************************
+Plays back a trace written by a demo run with DEMO_GL_TRACE=file
+and prints the CPU time spent in each kind of OpenGL call.
+The first frame also creates all of the buffers and shaders, it is played once,
+every later frame is played --loops times. What the demo deleted after its last frame
+is played once at the very end, so no loop draws with deleted objects.
+*/
+
+int main(int argc, char** argv){
+	if(argc < 2){
+		printf("usage: %s trace [--finish] [--loops N]\n", argv[0]);
+		return 1;
+	}
+	bool finish = false;
+	int loops = 1;
+	for(int i=2;i<argc;i++){
+		if(strcmp(argv[i],"--finish") == 0){
+			finish = true;
+		} else if(strcmp(argv[i],"--loops") == 0 && i+1 < argc){
+			loops = atoi(argv[++i]);
+		}
+	}
+	std::unique_ptr<GLTraceReplay> replay = GLTraceReplay::Create(argv[1]);
+	if(!replay){
+		return 1;
+	}
+	GLFWwindow* window = init(800,600,"GL Trace Replay",GLBackend::Native);
+	if(!window){
+		return 1;
+	}
+	//don't let VSYNC show up in the timings
+	glfwSwapInterval(0);
+	//every traced call has to reach the driver
+	removeGLStateCache();
+	for(int loop=0;loop<loops;loop++){
+		if(loop > 0){
+			replay->rewind();
+		}
+		while(replay->playFrame()){
+			if(finish){
+				glFinish();
+			}
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+	}
+	replay->playTeardown();
+	replay->printTimings();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Builds every demo with its headless-build.sh and runs it for a few frames, see "Headless Linux" in ReadMe.md
+# usage: sh headless-check.sh [frames]
+# Exits with 1 if any demo fails to build, or exits with an error, a crash or a shader that didn't link.
+frames=${1:-5}
+failed=0
+for demo in hello_world model_view_projection normals_lighting advanced_lighting cube_field; do
+	if ! (cd $demo && sh headless-build.sh > /dev/null 2>&1); then
+		echo "$demo: build failed"
+		failed=1
+		continue
+	fi
+	(cd $demo && DEMO_FRAME_LIMIT=$frames ./$demo > /dev/null 2>&1)
+	status=$?
+	if [ $status -ne 0 ]; then
+		echo "$demo: exited with $status"
+		failed=1
+	else
+		echo "$demo: ran $frames frames"
+	fi
+done
+exit $failed
@@ -0,0 +1 @@
+ gcc -c -O2 -D_GLFW_USE_CONFIG_H -DGLEW_STATIC -DGLEW_EGL -DGLEW_NO_GLU -I ../glew/include ../glew/glew.c ../glfw/src/context.c ../glfw/src/init.c ../glfw/src/input.c ../glfw/src/monitor.c ../glfw/src/window.c ../glfw/src/null_init.c ../glfw/src/null_monitor.c ../glfw/src/null_window.c ../glfw/src/null_joystick.c ../glfw/src/posix_time.c ../glfw/src/posix_tls.c ../glfw/src/egl_context.c && sh ../infrastructure/embed-shaders.sh embeddedshaders.gen.cpp *.vert *.frag *.geom *.glsl ../shaders/*.glsl && g++ -std=c++14 -O2 -DGLEW_STATIC -DGLEW_EGL -DGLEW_NO_GLU -DGLFW_INCLUDE_NONE -DGLM_FORCE_PURE -I ../infrastructure -I ../glew/include -I ../glfw/include ../infrastructure/*.cpp hello_world.cpp embeddedshaders.gen.cpp *.o -o hello_world -lEGL -lGL -lpthread && rm -f *.o
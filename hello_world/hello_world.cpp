@@ -153,7 +153,7 @@ int main(int argc, char* argv[]){
 			0,  //start with the first vertex
 			4); //draw 4 vertices (all of the ones in our buffer in our case)
 		//finally, update the screen with what we've drawn
-		glfwSwapBuffers(window);
+		swapBuffers(window);
 	};
 
 #ifdef __EMSCRIPTEN__
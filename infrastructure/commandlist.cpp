@@ -0,0 +1,38 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "commandlist.h"
+
+void ParallelCommandRecorder::record(size_t count, std::function<void(CommandList& list, size_t index)> build){
+	pool.parallelFor(count, [&](unsigned int worker, size_t begin, size_t end){
+		CommandList& list = lists[worker];
+		for(size_t i=begin;i<end;i++){
+			build(list, i);
+		}
+	});
+}
+
+void ParallelCommandRecorder::replay(RenderQueue& queue){
+	for(CommandList& list : lists){
+		queue.submit(list);
+		list.clear();
+	}
+}
@@ -0,0 +1,63 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "renderqueue.h"
+#include "workerpool.h"
+#include <functional>
+#include <vector>
+
+//Draw packets recorded without touching OpenGL, so it can be filled on any thread
+//	Nothing happens until the list is handed to a RenderQueue on the thread that owns the context.
+class CommandList {
+private:
+	std::vector<RenderPacket> packets;
+public:
+	void draw(Shader& shader, const Material& material, const DrawCall& mesh, const glm::mat4& transform, unsigned int layer = 0, float depth = 0.f){
+		packets.push_back(RenderPacket{&shader, &material, mesh, transform, layer, depth});
+	}
+	//keeps the memory around for the next frame
+	void clear(){
+		packets.clear();
+	}
+	size_t size() const {
+		return packets.size();
+	}
+	const std::vector<RenderPacket>& getPackets() const {
+		return packets;
+	}
+};
+
+//One command list per worker of a pool
+//	record() builds a frame's objects in parallel, replay() then feeds the lists to a queue
+//	in worker order, so the result doesn't depend on which thread finished first.
+class ParallelCommandRecorder {
+private:
+	WorkerPool& pool;
+	std::vector<CommandList> lists;
+public:
+	ParallelCommandRecorder(WorkerPool& pool) : pool(pool), lists(pool.getWorkerCount()) {}
+	//calls build once for every object index in [0,count), spread over the pool
+	//	build must not make OpenGL calls, only record into the list it is given
+	void record(size_t count, std::function<void(CommandList& list, size_t index)> build);
+	//submits every list to the queue on the calling (context) thread and clears them
+	void replay(RenderQueue& queue);
+};
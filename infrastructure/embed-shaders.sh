@@ -0,0 +1,34 @@
+#!/bin/sh
+# Writes a C++ file that compiles shader files into the program, see embeddedshaders.h
+# usage: embed-shaders.sh output.cpp files...
+# Files are registered by the path given here, so pass them as the demo opens them (../shaders/x.glsl).
+# Patterns that match nothing are skipped.
+out=$1
+shift
+{
+	echo '//generated by embed-shaders.sh, edit the shader files instead'
+	echo '#include "embeddedshaders.h"'
+	echo ''
+	echo 'namespace {'
+	i=0
+	for f in "$@"; do
+		[ -f "$f" ] || continue
+		printf 'constexpr char shader%d[] = R"glsl(' $i
+		cat "$f"
+		printf ')glsl";\n'
+		i=$((i+1))
+	done
+	echo 'constexpr EmbeddedShader shaders[] = {'
+	i=0
+	for f in "$@"; do
+		[ -f "$f" ] || continue
+		printf '\t{"%s", shader%d, sizeof(shader%d) - 1},\n' "$f" $i $i
+		i=$((i+1))
+	done
+	if [ $i -eq 0 ]; then
+		echo '	{"", "", 0},'
+	fi
+	echo '};'
+	echo 'EmbeddedShaderRegistration registration(shaders, sizeof(shaders) / sizeof(shaders[0]));'
+	echo '}'
+} > "$out"
@@ -0,0 +1,72 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "embeddedshaders.h"
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+//filled in by static initializers, so it has to exist before the first one runs
+std::unordered_map<std::string, const EmbeddedShader*>& embeddedShaders(){
+	static std::unordered_map<std::string, const EmbeddedShader*> shaders;
+	return shaders;
+}
+
+bool preferFiles(){
+	static const char* setting = getenv("DEMO_SHADER_FILES");
+	return setting && std::string(setting) == "1";
+}
+
+const EmbeddedShader* findEmbeddedShader(const std::string& name){
+	if(preferFiles()){
+		return nullptr;
+	}
+	auto found = embeddedShaders().find(name);
+	return found == embeddedShaders().end() ? nullptr : found->second;
+}
+}
+
+EmbeddedShaderRegistration::EmbeddedShaderRegistration(const EmbeddedShader* shaders, size_t count){
+	for(size_t i = 0; i < count; i++){
+		embeddedShaders()[shaders[i].name] = &shaders[i];
+	}
+}
+
+bool isEmbeddedShader(const std::string& name){
+	return findEmbeddedShader(name) != nullptr;
+}
+
+std::unique_ptr<FileView> openShaderFile(const std::string& name){
+	const EmbeddedShader* shader = findEmbeddedShader(name);
+	if(shader){
+		return FileView::Create(shader->source, shader->length);
+	}
+	return FileView::Create(name);
+}
+
+bool readShaderFile(const std::string& name, std::string& contents){
+	std::unique_ptr<FileView> view = openShaderFile(name);
+	if(!view){
+		return false;
+	}
+	contents.assign(view->begin(), view->end());
+	return true;
+}
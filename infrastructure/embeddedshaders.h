@@ -0,0 +1,50 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "fileview.h"
+
+//Shader files compiled into the program, so starting it reads no files (and under emscripten needs no --preload-file data)
+//	Each demo's build scripts run embed-shaders.sh, which writes embeddedshaders.gen.cpp with a registration like
+//		constexpr EmbeddedShader shaders[] = {{"lighting.frag", shader0, sizeof(shader0) - 1}, ...};
+//		EmbeddedShaderRegistration registration(shaders, 2);
+//	Builds without it (the Visual Studio projects) read the files as before.
+//	DEMO_SHADER_FILES=1 reads the files even when they are embedded, to edit them while the demo runs.
+struct EmbeddedShader {
+	//the path the file is opened by, relative to the demo's folder
+	const char* name;
+	const char* source;
+	size_t length;
+};
+
+struct EmbeddedShaderRegistration {
+	EmbeddedShaderRegistration(const EmbeddedShader* shaders, size_t count);
+};
+
+//true if reading name gets the embedded copy instead of the file
+bool isEmbeddedShader(const std::string& name);
+//a view of the embedded copy if there is one, otherwise of the file, empty if neither exists
+std::unique_ptr<FileView> openShaderFile(const std::string& name);
+//the same copied into a string, returns false if neither exists
+bool readShaderFile(const std::string& name, std::string& contents);
@@ -0,0 +1,125 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "fileview.h"
+#include <cstdio>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileView::FileView() : bytes(""), length(0), mapping(nullptr) {
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	fileMapping = nullptr;
+#endif
+}
+
+FileView::~FileView(){
+#ifdef _WIN32
+	if(mapping){
+		UnmapViewOfFile(mapping);
+	}
+	if(fileMapping){
+		CloseHandle(fileMapping);
+	}
+	if(file != INVALID_HANDLE_VALUE){
+		CloseHandle(file);
+	}
+#elif !defined(__EMSCRIPTEN__)
+	if(mapping){
+		munmap(mapping, length);
+	}
+#endif
+}
+
+std::unique_ptr<FileView> FileView::Create(const std::string& filename){
+	std::unique_ptr<FileView> view(new FileView());
+#ifdef _WIN32
+	view->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if(view->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(view->file, &size)){
+		return std::unique_ptr<FileView>();
+	}
+	//an empty file can't be mapped, the view just stays empty
+	if(size.QuadPart > 0){
+		view->fileMapping = CreateFileMappingA(view->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		view->mapping = view->fileMapping ? MapViewOfFile(view->fileMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if(!view->mapping){
+			printf("couldn't map %s\n", filename.c_str());
+			return std::unique_ptr<FileView>();
+		}
+		view->bytes = (const char*)view->mapping;
+		view->length = size_t(size.QuadPart);
+	}
+#elif defined(__EMSCRIPTEN__)
+	FILE* file = fopen(filename.c_str(), "rb");
+	if(!file){
+		return std::unique_ptr<FileView>();
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if(size > 0){
+		view->contents.resize(size);
+		view->length = fread(view->contents.data(), 1, size, file);
+		view->bytes = view->contents.data();
+	}
+	fclose(file);
+#else
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0){
+		return std::unique_ptr<FileView>();
+	}
+	struct stat info;
+	if(fstat(fd, &info) != 0){
+		close(fd);
+		return std::unique_ptr<FileView>();
+	}
+	//an empty file can't be mapped, the view just stays empty
+	if(info.st_size > 0){
+		void* mapping = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping == MAP_FAILED){
+			printf("couldn't map %s\n", filename.c_str());
+			close(fd);
+			return std::unique_ptr<FileView>();
+		}
+		view->mapping = mapping;
+		view->bytes = (const char*)mapping;
+		view->length = size_t(info.st_size);
+	}
+	//the mapping keeps the file open
+	close(fd);
+#endif
+	return view;
+}
+
+std::unique_ptr<FileView> FileView::Create(const char* data, size_t size){
+	std::unique_ptr<FileView> view(new FileView());
+	view->bytes = data;
+	view->length = size;
+	return view;
+}
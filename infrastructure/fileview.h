@@ -0,0 +1,62 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+//A read-only view of a whole file, mapped into memory instead of read into a buffer
+//	The pages are only read in when they are first touched and nothing is copied onto the heap,
+//	so even a large file costs no more to open than the parts of it that get used.
+//	data() is valid for as long as the view is. Under emscripten, which can't map files, the file is read once instead.
+class FileView {
+private:
+	const char* bytes;
+	size_t length;
+	//what the destructor has to give back
+	void* mapping;
+#ifdef _WIN32
+	void* file;
+	void* fileMapping;
+#endif
+	std::vector<char> contents;
+	FileView();
+public:
+	~FileView();
+	//empty if the file can't be opened
+	static std::unique_ptr<FileView> Create(const std::string& filename);
+	//a view of memory that outlives it, such as a file compiled into the program (see embeddedshaders.h)
+	static std::unique_ptr<FileView> Create(const char* data, size_t size);
+	const char* data() const {
+		return bytes;
+	}
+	size_t size() const {
+		return length;
+	}
+	const char* begin() const {
+		return bytes;
+	}
+	const char* end() const {
+		return bytes + length;
+	}
+};
@@ -0,0 +1,115 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "filewatcher.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define HAVE_INOTIFY
+#endif
+
+namespace {
+std::unordered_map<std::string, unsigned int> versions;
+#ifdef HAVE_INOTIFY
+int inotifyFd = -1;
+//the prefix that makes an event's file name into the name it was watched by, per watch descriptor
+std::unordered_map<int, std::string> directories;
+
+bool startInotify(){
+	static bool started = false;
+	if(!started){
+		started = true;
+		const char* setting = getenv("DEMO_HOT_RELOAD");
+		if(setting && std::string(setting) == "0"){
+			return false;
+		}
+		inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(inotifyFd < 0){
+			printf("inotify_init1 failed, shaders won't reload\n");
+		}
+	}
+	return inotifyFd >= 0;
+}
+#endif
+}
+
+bool isWatchingFiles(){
+#ifdef HAVE_INOTIFY
+	return startInotify();
+#else
+	return false;
+#endif
+}
+
+void watchFile(const std::string& filename){
+#ifdef HAVE_INOTIFY
+	if(!startInotify() || versions.count(filename)){
+		return;
+	}
+	size_t slash = filename.find_last_of('/');
+	std::string directory = slash == std::string::npos ? "." : filename.substr(0, slash);
+	//adding a directory again gives back the descriptor it already has
+	int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if(wd < 0){
+		printf("couldn't watch %s for changes\n", filename.c_str());
+		return;
+	}
+	directories[wd] = slash == std::string::npos ? "" : filename.substr(0, slash + 1);
+	versions[filename] = 0;
+#endif
+}
+
+void pollFileChanges(){
+#ifdef HAVE_INOTIFY
+	if(inotifyFd < 0){
+		return;
+	}
+	alignas(inotify_event) char buffer[4096];
+	for(;;){
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		if(length <= 0){
+			//EAGAIN once everything has been read
+			return;
+		}
+		for(char* p = buffer; p < buffer + length;){
+			const inotify_event* event = (const inotify_event*)p;
+			p += sizeof(inotify_event) + event->len;
+			auto directory = directories.find(event->wd);
+			if(event->len == 0 || directory == directories.end()){
+				continue;
+			}
+			auto version = versions.find(directory->second + event->name);
+			if(version != versions.end()){
+				version->second++;
+			}
+		}
+	}
+#endif
+}
+
+unsigned int fileVersion(const std::string& filename){
+	auto found = versions.find(filename);
+	return found == versions.end() ? 0 : found->second;
+}
@@ -0,0 +1,35 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <string>
+
+//Counts changes to files on disk, so whatever was loaded from them can tell that it is out of date
+//	Uses inotify on Linux, which watches the directories the files are in so that editors that save
+//	by writing a new file and renaming it over the old one are noticed too.
+//	Elsewhere, and with DEMO_HOT_RELOAD=0, a file's version never changes.
+bool isWatchingFiles();
+//starts counting changes to filename, from here on
+void watchFile(const std::string& filename);
+//picks up the changes since the last call without blocking, swapBuffers calls it once a frame
+void pollFileChanges();
+//goes up by one every time the file is written or replaced, 0 for files that aren't watched
+unsigned int fileVersion(const std::string& filename);
@@ -21,10 +21,21 @@ THE SOFTWARE.
 ***************************************************************************/
 #pragma once
 #include <GL/glew.h>
+#include "gldispatch.h"
 #include "glm/glm.hpp"
 #include "glm/ext.hpp"
+#include <algorithm>
 #include <cstring>
 
+//Everything needed to issue the draw of a geometry later (see renderqueue.h)
+//	indexType is 0 for geometry drawn with glDrawArrays
+struct DrawCall {
+	GLuint vao;
+	GLenum primitive;
+	GLsizei count;
+	GLenum indexType;
+};
+
 template<class T>
 class Geometry {
 protected:
@@ -36,17 +47,16 @@ public:
 		glGenBuffers(1,&vbo);
 		glBindVertexArray(vao);
 		glBindBuffer(GL_ARRAY_BUFFER,vbo);
-		size_t vbuffsize = T::vertexBufferSize();
-		char* vbuff = new char[vbuffsize];
-		T::tesselate(vbuff);
-		glBufferData(GL_ARRAY_BUFFER,vbuffsize,vbuff,GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER,T::vertexBufferSize(),T::vertexData(),GL_STATIC_DRAW);
 		T::configureAttributes();
 		glBindVertexArray(0);
 	}
 	void draw(){
 		glBindVertexArray(vao);
 		glDrawArrays(T::getPrimitiveType(),0,T::getVertexCount());
-		glBindVertexArray(0);
+	}
+	DrawCall getDrawCall(){
+		return DrawCall{vao, T::getPrimitiveType(), GLsizei(T::getVertexCount()), 0};
 	}
 };
 
@@ -64,41 +74,119 @@ public:
 		glBindVertexArray(vao);
 		glBindBuffer(GL_ARRAY_BUFFER,vbo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-		size_t vbuffsize = T::vertexBufferSize();
-		size_t ibuffsize = T::indexBufferSize();
-		char* vbuff = new char[vbuffsize];
-		char* ibuff = new char[ibuffsize];
-		T::tesselate(vbuff,ibuff);
-		glBufferData(GL_ARRAY_BUFFER,vbuffsize,vbuff,GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER,T::vertexBufferSize(),T::vertexData(),GL_STATIC_DRAW);
 		T::configureAttributes();
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER,ibuffsize,ibuff,GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER,T::indexBufferSize(),T::indexData(),GL_STATIC_DRAW);
 		glBindVertexArray(0);
 	}
 	void draw(){
 		glBindVertexArray(vao);
 		glDrawElements(T::getPrimitiveType(),T::getElementCount(),T::getIndexType(),0);
+	}
+	DrawCall getDrawCall(){
+		return DrawCall{vao, T::getPrimitiveType(), GLsizei(T::getElementCount()), T::getIndexType()};
+	}
+};
+
+//Per instance attributes of InstancedGeometry
+//	The model matrix takes four attribute locations starting at firstAttribute, material the one after
+struct InstanceData {
+	glm::mat4 modelMatrix;
+	glm::vec4 material;
+	static void configureAttributes(GLuint firstAttribute){
+		for(GLuint column=0;column<4;column++){
+			glEnableVertexAttribArray(firstAttribute+column);
+			glVertexAttribPointer(firstAttribute+column,4,GL_FLOAT,GL_FALSE,sizeof(InstanceData),(GLvoid*)(column*sizeof(glm::vec4)));
+			glVertexAttribDivisor(firstAttribute+column,1);
+		}
+		glEnableVertexAttribArray(firstAttribute+4);
+		glVertexAttribPointer(firstAttribute+4,4,GL_FLOAT,GL_FALSE,sizeof(InstanceData),(GLvoid*)(4*sizeof(glm::vec4)));
+		glVertexAttribDivisor(firstAttribute+4,1);
+	}
+};
+
+//Draws up to maxInstances copies of an indexed shape with one glDrawElementsInstanced
+//	Instance attributes come from I (see InstanceData) starting at firstInstanceAttribute,
+//	which has to be past the shape's own attributes.
+template<class T, class I = InstanceData>
+class InstancedGeometry : public IndexedGeometry<T> {
+protected:
+	GLuint instanceBuffer;
+	size_t maxInstances;
+	size_t instanceCount;
+public:
+	void init(size_t maxInstances, GLuint firstInstanceAttribute = 3){
+		IndexedGeometry<T>::init();
+		this->maxInstances = maxInstances;
+		instanceCount = 0;
+		glGenBuffers(1,&instanceBuffer);
+		glBindVertexArray(this->vao);
+		glBindBuffer(GL_ARRAY_BUFFER,instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER,maxInstances*sizeof(I),nullptr,GL_DYNAMIC_DRAW);
+		I::configureAttributes(firstInstanceAttribute);
 		glBindVertexArray(0);
 	}
+	//replaces instances [first,first+count), only that range is uploaded
+	//	Instances past the current count extend it.
+	void update(size_t first, const I* instances, size_t count){
+		if(first >= maxInstances){
+			return;
+		}
+		count = std::min(count, maxInstances - first);
+		glBindBuffer(GL_ARRAY_BUFFER,instanceBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER,first*sizeof(I),count*sizeof(I),instances);
+		instanceCount = std::max(instanceCount, first + count);
+	}
+	//draws only the first count instances, the rest keep their data
+	void setInstanceCount(size_t count){
+		instanceCount = std::min(count, maxInstances);
+	}
+	size_t getInstanceCount(){
+		return instanceCount;
+	}
+	size_t getMaxInstances(){
+		return maxInstances;
+	}
+	void draw(){
+		if(instanceCount == 0){
+			return;
+		}
+		glBindVertexArray(this->vao);
+		glDrawElementsInstanced(T::getPrimitiveType(),T::getElementCount(),T::getIndexType(),0,GLsizei(instanceCount));
+	}
+};
+
+//A fixed size array that constexpr functions can fill in, std::array can't be written to in a constant expression before C++17
+template<class T, size_t N>
+struct ConstantArray {
+	T values[N];
+	constexpr T& operator[](size_t i){
+		return values[i];
+	}
+	constexpr const T& operator[](size_t i) const {
+		return values[i];
+	}
+	const T* data() const {
+		return values;
+	}
 };
 
+//Shapes are tables worked out by the compiler, Geometry uploads them straight from read-only memory
+//	vertexData() has vertexBufferSize() bytes of interleaved floats, indexData() indexBufferSize() bytes of getIndexType().
 class Billboard{
 public:
 	static size_t vertexBufferSize(){
 		return 16*sizeof(float);
 	}
-	static void tesselate(char* vertexBuffer){
-		const float verts[] = {
+	static const float* vertexData(){
+		static constexpr float verts[] = {
 		//  xpos  ypos  xtex ytex
 			-1.0, -1.0, 0.0, 0.0,
 			 1.0, -1.0, 1.0, 0.0,
 			-1.0,  1.0, 0.0, 1.0,
 			 1.0,  1.0, 1.0, 1.0
 		};
-		//memcpy(vertexBuffer,verts,16*sizeof(float));
-		float* fbuffer = (float*)vertexBuffer;
-		for(int i=0;i<16;i++){
-			fbuffer[i] = verts[i];
-		}
+		return verts;
 	}
 	static void configureAttributes(){
 		glEnableVertexAttribArray(0);
@@ -114,32 +202,33 @@ public:
 	}
 };
 
+//position, normal and texture coordinate, the layout of Plane, Grid and SubdividedCube
+inline void configureShapeAttributes(){
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(GLvoid*)(3*sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),(GLvoid*)(6*sizeof(float)));
+}
+
 class Plane{
 public:
 	static size_t vertexBufferSize(){
 		return 4 * 8 *sizeof(float);
 	}
-	static void tesselate(char* vertexBuffer){
-		const float verts[] = {
+	static const float* vertexData(){
+		static constexpr float verts[] = {
 		//  xpos  ypos zpos  xn   yn   zn   xtex ytex
 			-1.0, 0.f, -1.0, 0.f, 1.f, 0.f, 0.0, 0.0,
 			 1.0, 0.f, -1.0, 0.f, 1.f, 0.f, 1.0, 0.0,
 			-1.0, 0.f,  1.0, 0.f, 1.f, 0.f, 0.0, 1.0,
 			 1.0, 0.f,  1.0, 0.f, 1.f, 0.f, 1.0, 1.0
 		};
-		//memcpy(vertexBuffer,verts,16*sizeof(float));
-		float* fbuffer = (float*)vertexBuffer;
-		for(int i=0;i<32;i++){
-			fbuffer[i] = verts[i];
-		}
+		return verts;
 	}
 	static void configureAttributes(){
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(GLvoid*)(3*sizeof(float)));
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),(GLvoid*)(6*sizeof(float)));
+		configureShapeAttributes();
 	}
 	static GLenum getPrimitiveType(){
 		return GL_TRIANGLE_STRIP;
@@ -149,10 +238,165 @@ public:
 	}
 };
 
+//One face of a cube: the outward normal, and the directions texture coordinates u and v run along it
+struct CubeFace {
+	float normal[3];
+	float u[3];
+	float v[3];
+};
+constexpr CubeFace cubeFaces[6] = {
+	{{ 0.f, 0.f, 1.f}, { 1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}},
+	{{ 0.f, 0.f,-1.f}, {-1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}},
+	{{ 0.f, 1.f, 0.f}, { 1.f, 0.f, 0.f}, {0.f, 0.f,-1.f}},
+	{{ 0.f,-1.f, 0.f}, { 1.f, 0.f, 0.f}, {0.f, 0.f, 1.f}},
+	{{ 1.f, 0.f, 0.f}, { 0.f, 0.f,-1.f}, {0.f, 1.f, 0.f}},
+	{{-1.f, 0.f, 0.f}, { 0.f, 0.f, 1.f}, {0.f, 1.f, 0.f}}
+};
+
+//Writes an N by N grid of quads covering one face (or the y = 0 plane), 8 floats a vertex, and its triangles
+//	Vertices go row by row from the face's (u,v) = (0,0) corner, each quad is triangles (a,b,c) (a,c,d)
+//	starting at its lowest corner and going counterclockwise seen from the normal's side.
+//	SharpCube's table winds its second triangles (c,a,d) the other way, which only matters with culling on.
+template<size_t VertexFloats, size_t Indices, class Index>
+constexpr void writeGrid(ConstantArray<float, VertexFloats>& vertices, ConstantArray<Index, Indices>& indices, size_t firstVertex, size_t firstIndex,
+	int n, const CubeFace& face, float offset){
+	int side = n + 1;
+	for(int y=0;y<side;y++){
+		for(int x=0;x<side;x++){
+			float s = float(x) / float(n), t = float(y) / float(n);
+			size_t at = (firstVertex + size_t(y * side + x)) * 8;
+			for(int c=0;c<3;c++){
+				vertices[at + c] = face.normal[c] * offset + face.u[c] * (2.f * s - 1.f) + face.v[c] * (2.f * t - 1.f);
+				vertices[at + 3 + c] = face.normal[c];
+			}
+			vertices[at + 6] = s;
+			vertices[at + 7] = t;
+		}
+	}
+	for(int y=0;y<n;y++){
+		for(int x=0;x<n;x++){
+			Index a = Index(firstVertex + size_t(y * side + x));
+			Index b = Index(a + 1), d = Index(a + side), c = Index(d + 1);
+			size_t at = firstIndex + size_t(y * n + x) * 6;
+			indices[at] = a;
+			indices[at + 1] = b;
+			indices[at + 2] = c;
+			indices[at + 3] = a;
+			indices[at + 4] = c;
+			indices[at + 5] = d;
+		}
+	}
+}
+
+//The y = 0 plane from -1 to 1 as N by N quads, for anything that bends or lights per vertex
+template<int N>
+class Grid{
+	static_assert(N > 0 && (N + 1) * (N + 1) <= 65536, "Grid side has to fit unsigned short indices");
+	static const size_t vertexCount = (N + 1) * (N + 1);
+	static const size_t indexCount = N * N * 6;
+	struct Tables {
+		ConstantArray<float, vertexCount * 8> vertices;
+		ConstantArray<GLushort, indexCount> indices;
+	};
+	static constexpr Tables tesselate(){
+		Tables tables{};
+		//laid out like the cube's +y face so the triangles wind counterclockwise seen from above
+		writeGrid(tables.vertices, tables.indices, 0, 0, N, cubeFaces[2], 0.f);
+		return tables;
+	}
+	static const Tables& tables(){
+		static constexpr Tables generated = tesselate();
+		return generated;
+	}
+public:
+	static size_t vertexBufferSize(){
+		return vertexCount * 8 * sizeof(float);
+	}
+	static size_t indexBufferSize(){
+		return indexCount * sizeof(GLushort);
+	}
+	static const float* vertexData(){
+		return tables().vertices.data();
+	}
+	static const void* indexData(){
+		return tables().indices.data();
+	}
+	static size_t getElementCount(){
+		return indexCount;
+	}
+	static GLenum getPrimitiveType(){
+		return GL_TRIANGLES;
+	}
+	static GLenum getIndexType(){
+		return GL_UNSIGNED_SHORT;
+	}
+	static void configureAttributes(){
+		configureShapeAttributes();
+	}
+};
+
+//A cube from -1 to 1 with every face split into N by N quads, with sharp edges like SharpCube
+template<int N>
+class SubdividedCube{
+	static_assert(N > 0 && 6 * (N + 1) * (N + 1) <= 65536, "SubdividedCube has to fit unsigned short indices");
+	static const size_t faceVertices = (N + 1) * (N + 1);
+	static const size_t faceIndices = N * N * 6;
+	struct Tables {
+		ConstantArray<float, 6 * faceVertices * 8> vertices;
+		ConstantArray<GLushort, 6 * faceIndices> indices;
+	};
+	static constexpr Tables tesselate(){
+		Tables tables{};
+		for(size_t f=0;f<6;f++){
+			writeGrid(tables.vertices, tables.indices, f * faceVertices, f * faceIndices, N, cubeFaces[f], 1.f);
+		}
+		return tables;
+	}
+	static const Tables& tables(){
+		static constexpr Tables generated = tesselate();
+		return generated;
+	}
+public:
+	static size_t vertexBufferSize(){
+		return 6 * faceVertices * 8 * sizeof(float);
+	}
+	static size_t indexBufferSize(){
+		return 6 * faceIndices * sizeof(GLushort);
+	}
+	static const float* vertexData(){
+		return tables().vertices.data();
+	}
+	static const void* indexData(){
+		return tables().indices.data();
+	}
+	static size_t getElementCount(){
+		return 6 * faceIndices;
+	}
+	static GLenum getPrimitiveType(){
+		return GL_TRIANGLES;
+	}
+	static GLenum getIndexType(){
+		return GL_UNSIGNED_SHORT;
+	}
+	static void configureAttributes(){
+		configureShapeAttributes();
+	}
+};
+
 class SharpCube{
+	static constexpr ConstantArray<GLubyte, 36> tesselateIndices(){
+		ConstantArray<GLubyte, 36> indices{};
+		const GLubyte quad[] = {0, 1, 2, 2, 0, 3};
+		for(GLubyte f=0;f<6;f++){
+			for(GLubyte i=0;i<6;i++){
+				indices[6*f+i] = GLubyte(quad[i] + 4*f);
+			}
+		}
+		return indices;
+	}
 public:
 	static size_t vertexBufferSize(){
-		return 24 * 8 * sizeof(float);//6 * Plane::vertexBufferSize();
+		return 24 * 8 * sizeof(float);
 	}
 	static size_t indexBufferSize(){
 		return 6*6;
@@ -166,8 +410,8 @@ public:
 	static GLenum getIndexType(){
 		return GL_UNSIGNED_BYTE;
 	}
+	//unlike Plane the texture coordinate comes before the normal
 	static void configureAttributes(){
-		//Plane::configureAttributes();
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),0);
 		glEnableVertexAttribArray(1);
@@ -175,8 +419,8 @@ public:
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),(GLvoid*)(3*sizeof(float)));
 	}
-	static void tesselate(char* vertexBuffer, char* indexBuffer){
-		const float g_cube[24][8] =
+	static const float* vertexData(){
+		static constexpr float g_cube[24][8] =
 		{
 			// Positive Z Face.
 			{ -1.0f, -1.0f,  1.0f,  0.0f, 0.0f,  0.0f, 0.0f, 1.0f},
@@ -214,44 +458,10 @@ public:
 			{ -1.0f,  1.0f,  1.0f,  1.0f, 1.0f,  -1.0f, 0.0f, 0.0f},
 			{ -1.0f,  1.0f, -1.0f,  0.0f, 1.0f,  -1.0f, 0.0f, 0.0f}
 		};
-		memcpy(vertexBuffer,g_cube,sizeof(g_cube));
-		/*Plane::tesselate(vertexBuffer);
-		glm::mat4 transforms[6];
-		transforms[0] = glm::mat4();
-		transforms[1] = glm::rotate(transforms[0],180.f,glm::vec3(1.f,0.f,0.f));
-		transforms[2] = glm::rotate(transforms[0],90.f,glm::vec3(1.f,0.f,0.f));
-		transforms[3] = glm::rotate(transforms[0],270.f,glm::vec3(1.f,0.f,0.f));
-		transforms[4] = glm::rotate(transforms[0],90.f,glm::vec3(0.f,0.f,1.f));
-		transforms[5] = glm::rotate(transforms[0],270.f,glm::vec3(0.f,0.f,1.f));
-		float* fbuff = (float*)vertexBuffer;
-		fbuff[1] = 1.f;
-		fbuff[9] = 1.f;
-		fbuff[17] = 1.f;
-		fbuff[25] = 1.f;
-		for(int f=1;f<6;f++){
-			float* baseindex = fbuff+(9*f);
-			for(int v=0;v<4;v++){
-				float* index = baseindex+(3*v);
-				float* vbuff = fbuff + (3*v);
-				glm::vec3 pos(vbuff[0],vbuff[1],vbuff[2]);
-				glm::vec3 norm(vbuff[3],vbuff[4],vbuff[5]);
-				glm::vec4 tpos = transforms[0] * glm::vec4(pos,1.f);
-				glm::vec4 tnorm = transforms[0] * glm::vec4(norm,0.f);
-				index[0] = tpos.x;
-				index[1] = tpos.y;
-				index[2] = tpos.z;
-				index[3] = tnorm.x;
-				index[4] = tnorm.y;
-				index[5] = tnorm.z;
-				index[6] = vbuff[6];
-				index[7] = vbuff[7];
-			}
-		}*/
-		GLubyte indices[] = {0, 1, 2, 2, 0, 3};
-		for(GLubyte f=0;f<6;f++){
-			for(GLubyte i=0;i<6;i++){
-				((GLubyte*)indexBuffer)[6*f+i] = indices[i] + (4*f);
-			}
-		}
+		return g_cube[0];
+	}
+	static const void* indexData(){
+		static constexpr ConstantArray<GLubyte, 36> indices = tesselateIndices();
+		return indices.data();
 	}
 };
@@ -0,0 +1,230 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "gldebug.h"
+#include <GLFW/glfw3.h>
+#include "glloader.h"
+#include "infrastructure.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifndef __EMSCRIPTEN__
+namespace {
+//what the callback copies out of the driver, longer messages are cut off
+struct DebugMessage {
+	GLenum source;
+	GLenum type;
+	GLenum severity;
+	GLuint id;
+	char text[500];
+};
+
+//Bounded queue for any number of writers (the driver may call back from its own threads) and one reader
+//	Each slot's sequence says whose turn it is: a writer may fill slot i when it is i and publishes it as i + 1,
+//	the reader frees it for the next lap by setting it to i + size.
+const size_t queueSize = 256;
+struct QueueSlot {
+	std::atomic<size_t> sequence;
+	DebugMessage message;
+};
+QueueSlot queue[queueSize];
+std::atomic<size_t> writePosition(0);
+size_t readPosition = 0;
+std::atomic<unsigned int> lostMessages(0);
+
+bool push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* text){
+	size_t position = writePosition.load(std::memory_order_relaxed);
+	while(true){
+		QueueSlot& slot = queue[position % queueSize];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if(sequence == position){
+			if(writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+				DebugMessage& message = slot.message;
+				message.source = source;
+				message.type = type;
+				message.id = id;
+				message.severity = severity;
+				size_t size = length < 0 ? strlen(text) : size_t(length);
+				size = std::min(size, sizeof(message.text) - 1);
+				memcpy(message.text, text, size);
+				message.text[size] = 0;
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		} else if(sequence < position + 1){
+			//full, the reader hasn't freed this slot from the last lap
+			return false;
+		} else {
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool pop(DebugMessage& message){
+	QueueSlot& slot = queue[readPosition % queueSize];
+	if(slot.sequence.load(std::memory_order_acquire) != readPosition + 1){
+		return false;
+	}
+	message = slot.message;
+	slot.sequence.store(readPosition + queueSize, std::memory_order_release);
+	readPosition++;
+	return true;
+}
+
+void APIENTRY queueMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* text, const void*){
+	if(!push(source, type, id, severity, length, text)){
+		lostMessages.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+//the logger thread
+const int messagesPerSecond = 10;
+const std::chrono::milliseconds pollInterval(20);
+
+class Logger {
+private:
+	std::thread thread;
+	std::atomic<bool> stopping;
+	//times each distinct message was seen since it was last reported
+	std::unordered_map<size_t, unsigned int> repeats;
+	unsigned int shownThisSecond;
+	unsigned int repeated;
+	unsigned int overLimit;
+	std::chrono::steady_clock::time_point second;
+	void drain(){
+		DebugMessage message;
+		while(pop(message)){
+			size_t key = std::hash<std::string>()(message.text) ^ (size_t(message.id) << 1) ^ (size_t(message.type) << 17) ^ (size_t(message.source) << 33);
+			auto seen = repeats.find(key);
+			if(seen != repeats.end()){
+				seen->second++;
+				repeated++;
+			} else if(shownThisSecond >= messagesPerSecond){
+				overLimit++;
+			} else {
+				repeats[key] = 0;
+				shownThisSecond++;
+				openglErrorCallback(message.source, message.type, message.id, message.severity, -1, message.text, nullptr);
+			}
+		}
+		auto now = std::chrono::steady_clock::now();
+		if(now - second < std::chrono::seconds(1)){
+			return;
+		}
+		unsigned int lost = lostMessages.exchange(0, std::memory_order_relaxed);
+		if(repeated || overLimit || lost){
+			printf("GL debug: %u repeated messages, %u over the limit of %d a second and %u that didn't fit in the queue weren't shown\n",
+				repeated, overLimit, messagesPerSecond, lost);
+		}
+		repeated = 0;
+		overLimit = 0;
+		shownThisSecond = 0;
+		second = now;
+	}
+	void run(){
+		while(!stopping.load()){
+			drain();
+			std::this_thread::sleep_for(pollInterval);
+		}
+		drain();
+	}
+public:
+	Logger() : stopping(false), shownThisSecond(0), repeated(0), overLimit(0) {}
+	~Logger(){
+		stop();
+	}
+	void start(){
+		if(thread.joinable()){
+			return;
+		}
+		for(size_t i=0;i<queueSize;i++){
+			queue[i].sequence.store(i);
+		}
+		writePosition.store(0);
+		readPosition = 0;
+		second = std::chrono::steady_clock::now();
+		thread = std::thread(&Logger::run, this);
+	}
+	void stop(){
+		if(thread.joinable()){
+			stopping.store(true);
+			thread.join();
+		}
+	}
+};
+Logger logger;
+}
+#endif
+
+GLDebugMode glDebugModeFromEnvironment(){
+	const char* setting = getenv("DEMO_GL_DEBUG");
+	if(setting && std::string(setting) == "sync"){
+		return GLDebugMode::Synchronous;
+	} else if(setting && std::string(setting) == "off"){
+		return GLDebugMode::Off;
+	}
+	return GLDebugMode::Asynchronous;
+}
+
+bool startGLDebugOutput(GLDebugMode mode){
+	if(mode == GLDebugMode::Off){
+		return true;
+	}
+#ifdef __EMSCRIPTEN__
+	//WebGL has no debug output
+	return false;
+#else
+	bool khr = glDebugMessageCallback != 0x0 && glDebugMessageControl != 0x0 && hasGLExtension("GL_KHR_debug");
+	bool arb = glDebugMessageCallbackARB != 0x0 && glDebugMessageControlARB != 0x0 && hasGLExtension("GL_ARB_debug_output");
+	if(!khr && !arb){
+		return false;
+	}
+	PFNGLDEBUGMESSAGECONTROLPROC control = khr ? glDebugMessageControl : glDebugMessageControlARB;
+	//openglErrorCallback ignores these anyway
+	control(GL_DONT_CARE, GL_DEBUG_TYPE_OTHER, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+	GLDEBUGPROC callback = (GLDEBUGPROC)openglErrorCallback;
+	if(mode == GLDebugMode::Asynchronous){
+		//GL_ARB_debug_output has no notifications
+		if(khr){
+			control(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+		}
+		logger.start();
+		callback = (GLDEBUGPROC)queueMessage;
+	}
+	if(khr){
+		glDebugMessageCallback(callback, nullptr);
+	} else {
+		glDebugMessageCallbackARB((GLDEBUGPROCARB)callback, nullptr);
+	}
+	glEnable(GL_DEBUG_OUTPUT);
+	if(mode == GLDebugMode::Synchronous){
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+	return true;
+#endif
+}
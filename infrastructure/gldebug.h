@@ -0,0 +1,40 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "gldispatch.h"
+
+//How the context's debug messages (GL_KHR_debug or GL_ARB_debug_output) reach the console
+enum class GLDebugMode {
+	Off,
+	//GL_DEBUG_OUTPUT_SYNCHRONOUS and printed from inside the call that caused them, for stepping through in a debugger
+	Synchronous,
+	//The driver keeps running ahead. Messages go raw into a lock-free queue that a logger thread prints,
+	//	showing each distinct message once and at most a few a second, with a count of what it held back.
+	//	Notifications and GL_DEBUG_TYPE_OTHER are turned off in the driver so they are never generated.
+	Asynchronous
+};
+
+//from DEMO_GL_DEBUG: "sync", "off", anything else is Asynchronous
+GLDebugMode glDebugModeFromEnvironment();
+//Needs a current context and loadGL. Returns false if the context has no debug extension,
+//	which is always the case under emscripten: WebGL has no debug output.
+bool startGLDebugOutput(GLDebugMode mode);
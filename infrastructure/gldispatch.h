@@ -0,0 +1,109 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+
+//GLEW reaches almost every OpenGL function through a pointer (loaded by loadGL, see glloader.h),
+//	but the OpenGL 1.1 functions are exported directly by the system library.
+//	This gives the 1.1 functions the demos use a pointer as well,
+//	so that the whole API can be swapped out at init() time (see glrecorder.h)
+
+typedef void (GLAPIENTRY * PFNGLDISPATCHCLEARPROC)(GLbitfield mask);
+typedef void (GLAPIENTRY * PFNGLDISPATCHCLEARCOLORPROC)(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+typedef void (GLAPIENTRY * PFNGLDISPATCHENABLEPROC)(GLenum cap);
+typedef void (GLAPIENTRY * PFNGLDISPATCHDISABLEPROC)(GLenum cap);
+typedef void (GLAPIENTRY * PFNGLDISPATCHVIEWPORTPROC)(GLint x, GLint y, GLsizei width, GLsizei height);
+typedef void (GLAPIENTRY * PFNGLDISPATCHDEPTHFUNCPROC)(GLenum func);
+typedef void (GLAPIENTRY * PFNGLDISPATCHDEPTHMASKPROC)(GLboolean flag);
+typedef void (GLAPIENTRY * PFNGLDISPATCHCOLORMASKPROC)(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+typedef void (GLAPIENTRY * PFNGLDISPATCHBLENDFUNCPROC)(GLenum sfactor, GLenum dfactor);
+typedef void (GLAPIENTRY * PFNGLDISPATCHCULLFACEPROC)(GLenum mode);
+typedef void (GLAPIENTRY * PFNGLDISPATCHDRAWARRAYSPROC)(GLenum mode, GLint first, GLsizei count);
+typedef void (GLAPIENTRY * PFNGLDISPATCHDRAWELEMENTSPROC)(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+typedef const GLubyte* (GLAPIENTRY * PFNGLDISPATCHGETSTRINGPROC)(GLenum name);
+typedef void (GLAPIENTRY * PFNGLDISPATCHGETINTEGERVPROC)(GLenum pname, GLint* params);
+typedef GLenum (GLAPIENTRY * PFNGLDISPATCHGETERRORPROC)(void);
+typedef void (GLAPIENTRY * PFNGLDISPATCHFLUSHPROC)(void);
+typedef void (GLAPIENTRY * PFNGLDISPATCHFINISHPROC)(void);
+
+struct GLDispatch {
+	PFNGLDISPATCHCLEARPROC Clear;
+	PFNGLDISPATCHCLEARCOLORPROC ClearColor;
+	PFNGLDISPATCHENABLEPROC Enable;
+	PFNGLDISPATCHDISABLEPROC Disable;
+	PFNGLDISPATCHVIEWPORTPROC Viewport;
+	PFNGLDISPATCHDEPTHFUNCPROC DepthFunc;
+	PFNGLDISPATCHDEPTHMASKPROC DepthMask;
+	PFNGLDISPATCHCOLORMASKPROC ColorMask;
+	PFNGLDISPATCHBLENDFUNCPROC BlendFunc;
+	PFNGLDISPATCHCULLFACEPROC CullFace;
+	PFNGLDISPATCHDRAWARRAYSPROC DrawArrays;
+	PFNGLDISPATCHDRAWELEMENTSPROC DrawElements;
+	PFNGLDISPATCHGETSTRINGPROC GetString;
+	PFNGLDISPATCHGETINTEGERVPROC GetIntegerv;
+	PFNGLDISPATCHGETERRORPROC GetError;
+	PFNGLDISPATCHFLUSHPROC Flush;
+	PFNGLDISPATCHFINISHPROC Finish;
+};
+
+//starts out pointing at the system OpenGL library
+extern GLDispatch glDispatch;
+
+//emscripten redeclares the 1.1 functions in its own headers, and there is nothing to swap on the web anyway
+#if !defined(__EMSCRIPTEN__) && !defined(GL_DISPATCH_IMPLEMENTATION)
+#define glClear glDispatch.Clear
+#define glClearColor glDispatch.ClearColor
+#define glEnable glDispatch.Enable
+#define glDisable glDispatch.Disable
+#define glViewport glDispatch.Viewport
+#define glDepthFunc glDispatch.DepthFunc
+#define glDepthMask glDispatch.DepthMask
+#define glColorMask glDispatch.ColorMask
+#define glBlendFunc glDispatch.BlendFunc
+#define glCullFace glDispatch.CullFace
+#define glDrawArrays glDispatch.DrawArrays
+#define glDrawElements glDispatch.DrawElements
+#define glGetString glDispatch.GetString
+#define glGetIntegerv glDispatch.GetIntegerv
+#define glGetError glDispatch.GetError
+#define glFlush glDispatch.Flush
+#define glFinish glDispatch.Finish
+#endif
+
+//glBufferStorage is newer (OpenGL 4.4) than the bundled GLEW, so loadGL loads it by hand
+//	It stays null when the context doesn't have GL_ARB_buffer_storage.
+#ifndef GL_ARB_buffer_storage
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+typedef void (GLAPIENTRY * PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const GLvoid* data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC glBufferStorage;
+#endif
+//the same goes for KHR_parallel_shader_compile (or its ARB twin, loaded into the same pointer)
+//	When it is there the driver compiles in the background and GL_COMPLETION_STATUS_KHR can be polled without blocking.
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (GLAPIENTRY * PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+#endif
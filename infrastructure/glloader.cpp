@@ -0,0 +1,119 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "glloader.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+
+static std::unordered_set<std::string> extensions;
+static int majorVersion = 0;
+static int minorVersion = 0;
+
+static void readExtensions(){
+	extensions.clear();
+	GLint count = 0;
+	if(glGetStringi){
+		glGetIntegerv(GL_NUM_EXTENSIONS,&count);
+	}
+	if(count > 0){
+		extensions.reserve(count);
+		for(GLint i=0;i<count;i++){
+			const char* extension = (const char*)glGetStringi(GL_EXTENSIONS,i);
+			if(extension){
+				extensions.insert(extension);
+			}
+		}
+		return;
+	}
+	//contexts older than 3.0 only have the one string
+	const char* list = (const char*)glGetString(GL_EXTENSIONS);
+	while(list && *list){
+		const char* end = list;
+		while(*end && *end != ' '){
+			end++;
+		}
+		if(end != list){
+			extensions.insert(std::string(list,end));
+		}
+		list = *end ? end + 1 : end;
+	}
+}
+
+static void readVersion(){
+	majorVersion = 0;
+	minorVersion = 0;
+	const char* version = (const char*)glGetString(GL_VERSION);
+	if(!version){
+		return;
+	}
+	//"4.5 (Core Profile) Mesa ...", "OpenGL ES 3.0 ..." or "OpenGL ES 3.0 (WebGL 2.0 ...)"
+	while(*version && (*version < '0' || *version > '9')){
+		version++;
+	}
+	sscanf(version,"%d.%d",&majorVersion,&minorVersion);
+}
+
+bool loadGL(){
+	auto start = std::chrono::steady_clock::now();
+	int loaded = 0, total = 0;
+#ifdef __EMSCRIPTEN__
+	//the browser's functions are linked in directly, there is nothing to look up
+	glewInit();
+#else
+#define X(name) \
+	__glew##name = (decltype(__glew##name))glfwGetProcAddress("gl" #name); \
+	loaded += __glew##name ? 1 : 0; \
+	total++;
+	LOADED_GL_FUNCTIONS(X)
+#undef X
+#endif
+	readVersion();
+	if(majorVersion == 0 || !glCreateShader){
+		printf("This OpenGL context can't run shaders\n");
+		return false;
+	}
+	readExtensions();
+#ifndef __EMSCRIPTEN__
+	//GLEW predates glBufferStorage and parallel shader compiles, see gldispatch.h
+	if(hasGLExtension("GL_ARB_buffer_storage")){
+		glBufferStorage = (PFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+	}
+	if(hasGLExtension("GL_KHR_parallel_shader_compile")){
+		glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+	} else if(hasGLExtension("GL_ARB_parallel_shader_compile")){
+		glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+	}
+#endif
+	double milliseconds = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("Status: Loaded %d of %d OpenGL functions and %zu extensions in %.2f ms\n",loaded,total,extensions.size(),milliseconds);
+	return true;
+}
+
+bool hasGLExtension(const char* name){
+	return extensions.count(name) != 0;
+}
+
+bool hasGLVersion(int major, int minor){
+	return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "gldispatch.h"
+
+//The OpenGL functions past 1.1 that the demos and infrastructure call
+//	GLEW's headers still declare them, but only these pointers get loaded instead of every one GLEW knows.
+//	Add a function here before calling it, otherwise its pointer stays null.
+#define LOADED_GL_FUNCTIONS(X) \
+	X(GetStringi) X(DebugMessageCallback) X(DebugMessageCallbackARB) X(DebugMessageControl) X(DebugMessageControlARB) \
+	X(DrawArraysInstanced) X(DrawElementsInstanced) X(MultiDrawElementsIndirect) \
+	X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) X(BufferData) X(BufferSubData) \
+	X(MapBufferRange) X(FlushMappedBufferRange) X(UnmapBuffer) \
+	X(FenceSync) X(ClientWaitSync) X(DeleteSync) \
+	X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) \
+	X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribDivisor) \
+	X(CreateShader) X(DeleteShader) X(ShaderSource) X(CompileShader) X(GetShaderiv) X(GetShaderInfoLog) \
+	X(CreateProgram) X(DeleteProgram) X(AttachShader) X(BindAttribLocation) X(LinkProgram) \
+	X(GetProgramiv) X(GetProgramInfoLog) X(UseProgram) X(ProgramParameteri) X(GetProgramBinary) X(ProgramBinary) \
+	X(GetActiveUniform) X(GetActiveAttrib) X(GetUniformLocation) X(GetAttribLocation) \
+	X(GetUniformBlockIndex) X(UniformBlockBinding) \
+	X(Uniform1i) X(Uniform1f) X(Uniform3f) X(Uniform4f) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix4fv)
+
+//Takes the place of glewInit: loads LOADED_GL_FUNCTIONS in one pass, plus glBufferStorage and
+//	glMaxShaderCompilerThreadsKHR when the context has them (see gldispatch.h), and reads the extension list once.
+//	There needs to be a current context. Fails if the context can't run shaders at all.
+bool loadGL();
+//Answered from a hash set of the context's extensions, not by searching the GL_EXTENSIONS string
+bool hasGLExtension(const char* name);
+//The context's version is at least major.minor
+bool hasGLVersion(int major, int minor);
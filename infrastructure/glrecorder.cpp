@@ -0,0 +1,277 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "glrecorder.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+static bool recording = false;
+static GLFrameStats currentFrame;
+static GLFrameStats lastFrame;
+static unsigned int frameNumber = 0;
+static GLuint nextName = 1;
+static GLint nextUniformLocation = 0;
+static PFNGLDISPATCHGETINTEGERVPROC nativeGetIntegerv;
+//the caller writes through mapped pointers, so they need real memory behind them
+//	Each buffer keeps its block from one map to the next, until the buffer is deleted.
+static std::unordered_map<GLenum,GLuint> boundBuffers;
+static std::unordered_map<GLuint,std::vector<char>> mappedMemory;
+
+static inline void record(GLCall call){
+	currentFrame.calls[call]++;
+	currentFrame.totalCalls++;
+}
+static inline void recordState(GLCall call){
+	record(call);
+	currentFrame.stateChanges++;
+}
+static inline void recordDraw(GLCall call){
+	record(call);
+	currentFrame.drawCalls++;
+}
+static inline void recordUniform(GLCall call, size_t bytes){
+	record(call);
+	currentFrame.uniformBytes += bytes;
+}
+
+//OpenGL 1.1
+static void GLAPIENTRY recordClear(GLbitfield){ record(GLCall_Clear); }
+static void GLAPIENTRY recordClearColor(GLclampf, GLclampf, GLclampf, GLclampf){ recordState(GLCall_ClearColor); }
+static void GLAPIENTRY recordEnable(GLenum){ recordState(GLCall_Enable); }
+static void GLAPIENTRY recordDisable(GLenum){ recordState(GLCall_Disable); }
+static void GLAPIENTRY recordViewport(GLint, GLint, GLsizei, GLsizei){ recordState(GLCall_Viewport); }
+static void GLAPIENTRY recordDepthFunc(GLenum){ recordState(GLCall_DepthFunc); }
+static void GLAPIENTRY recordDepthMask(GLboolean){ recordState(GLCall_DepthMask); }
+static void GLAPIENTRY recordColorMask(GLboolean, GLboolean, GLboolean, GLboolean){ recordState(GLCall_ColorMask); }
+static void GLAPIENTRY recordBlendFunc(GLenum, GLenum){ recordState(GLCall_BlendFunc); }
+static void GLAPIENTRY recordCullFace(GLenum){ recordState(GLCall_CullFace); }
+static void GLAPIENTRY recordDrawArrays(GLenum, GLint, GLsizei){ recordDraw(GLCall_DrawArrays); }
+static void GLAPIENTRY recordDrawElements(GLenum, GLsizei, GLenum, const GLvoid*){ recordDraw(GLCall_DrawElements); }
+static const GLubyte* GLAPIENTRY recordGetString(GLenum name){
+	record(GLCall_GetString);
+	switch(name){
+	case GL_VERSION:
+		return (const GLubyte*)"3.3 Recording";
+	case GL_SHADING_LANGUAGE_VERSION:
+		return (const GLubyte*)"3.30 Recording";
+	case GL_EXTENSIONS:
+		return (const GLubyte*)"";
+	default:
+		return (const GLubyte*)"Recording";
+	}
+}
+static void GLAPIENTRY recordGetIntegerv(GLenum pname, GLint* params){
+	record(GLCall_GetIntegerv);
+	switch(pname){
+	case GL_MAJOR_VERSION:
+		*params = 3;
+		break;
+	case GL_MINOR_VERSION:
+		*params = 3;
+		break;
+	case GL_NUM_EXTENSIONS:
+		//glGetStringi isn't recorded, so extensions are those of the real context, same as hasGLExtension
+		nativeGetIntegerv(pname, params);
+		break;
+	default:
+		*params = 0;
+		break;
+	}
+}
+static GLenum GLAPIENTRY recordGetError(){ record(GLCall_GetError); return GL_NO_ERROR; }
+static void GLAPIENTRY recordFlush(){ record(GLCall_Flush); }
+static void GLAPIENTRY recordFinish(){ record(GLCall_Finish); }
+
+//buffers & vertex arrays
+static void GLAPIENTRY recordGenBuffers(GLsizei n, GLuint* buffers){
+	record(GLCall_GenBuffers);
+	for(GLsizei i=0;i<n;i++){
+		buffers[i] = nextName++;
+	}
+}
+static void GLAPIENTRY recordDeleteBuffers(GLsizei n, const GLuint* buffers){
+	record(GLCall_DeleteBuffers);
+	for(GLsizei i=0;i<n;i++){
+		mappedMemory.erase(buffers[i]);
+	}
+}
+//the indexed binds also bind the buffer to the target itself
+static void GLAPIENTRY recordBindBuffer(GLenum target, GLuint buffer){
+	recordState(GLCall_BindBuffer);
+	boundBuffers[target] = buffer;
+}
+static void GLAPIENTRY recordBindBufferBase(GLenum target, GLuint, GLuint buffer){
+	recordState(GLCall_BindBufferBase);
+	boundBuffers[target] = buffer;
+}
+static void GLAPIENTRY recordBindBufferRange(GLenum target, GLuint, GLuint buffer, GLintptr, GLsizeiptr){
+	recordState(GLCall_BindBufferRange);
+	boundBuffers[target] = buffer;
+}
+static void GLAPIENTRY recordBufferData(GLenum, GLsizeiptr size, const GLvoid*, GLenum){
+	record(GLCall_BufferData);
+	currentFrame.bufferBytes += size;
+}
+static void GLAPIENTRY recordBufferSubData(GLenum, GLintptr, GLsizeiptr size, const GLvoid*){
+	record(GLCall_BufferSubData);
+	currentFrame.bufferBytes += size;
+}
+static void GLAPIENTRY recordBufferStorage(GLenum, GLsizeiptr size, const GLvoid*, GLbitfield){
+	record(GLCall_BufferStorage);
+	currentFrame.bufferBytes += size;
+}
+static GLvoid* GLAPIENTRY recordMapBufferRange(GLenum target, GLintptr, GLsizeiptr length, GLbitfield){
+	record(GLCall_MapBufferRange);
+	std::vector<char>& memory = mappedMemory[boundBuffers[target]];
+	if(memory.size() < size_t(length)){
+		memory.resize(length);
+	}
+	return memory.data();
+}
+static void GLAPIENTRY recordFlushMappedBufferRange(GLenum, GLintptr, GLsizeiptr length){
+	record(GLCall_FlushMappedBufferRange);
+	currentFrame.bufferBytes += length;
+}
+static GLboolean GLAPIENTRY recordUnmapBuffer(GLenum){ record(GLCall_UnmapBuffer); return GL_TRUE; }
+
+//sync objects, the GPU is never behind
+static GLsync GLAPIENTRY recordFenceSync(GLenum, GLbitfield){ record(GLCall_FenceSync); return (GLsync)(uintptr_t)nextName++; }
+static GLenum GLAPIENTRY recordClientWaitSync(GLsync, GLbitfield, GLuint64){ record(GLCall_ClientWaitSync); return GL_ALREADY_SIGNALED; }
+static void GLAPIENTRY recordDeleteSync(GLsync){ record(GLCall_DeleteSync); }
+static void GLAPIENTRY recordGenVertexArrays(GLsizei n, GLuint* arrays){
+	record(GLCall_GenVertexArrays);
+	for(GLsizei i=0;i<n;i++){
+		arrays[i] = nextName++;
+	}
+}
+static void GLAPIENTRY recordDeleteVertexArrays(GLsizei, const GLuint*){ record(GLCall_DeleteVertexArrays); }
+static void GLAPIENTRY recordBindVertexArray(GLuint){ recordState(GLCall_BindVertexArray); }
+static void GLAPIENTRY recordEnableVertexAttribArray(GLuint){ recordState(GLCall_EnableVertexAttribArray); }
+static void GLAPIENTRY recordVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const GLvoid*){ recordState(GLCall_VertexAttribPointer); }
+static void GLAPIENTRY recordVertexAttribDivisor(GLuint, GLuint){ recordState(GLCall_VertexAttribDivisor); }
+
+//instancing
+static void GLAPIENTRY recordDrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei){ recordDraw(GLCall_DrawArraysInstanced); }
+static void GLAPIENTRY recordDrawElementsInstanced(GLenum, GLsizei, GLenum, const GLvoid*, GLsizei){ recordDraw(GLCall_DrawElementsInstanced); }
+static void GLAPIENTRY recordMultiDrawElementsIndirect(GLenum, GLenum, const GLvoid*, GLsizei, GLsizei){ recordDraw(GLCall_MultiDrawElementsIndirect); }
+
+//shaders, every compile and link succeeds
+static GLuint GLAPIENTRY recordCreateShader(GLenum){ record(GLCall_CreateShader); return nextName++; }
+static void GLAPIENTRY recordDeleteShader(GLuint){ record(GLCall_DeleteShader); }
+static void GLAPIENTRY recordShaderSource(GLuint, GLsizei, const GLchar**, const GLint*){ record(GLCall_ShaderSource); }
+static void GLAPIENTRY recordCompileShader(GLuint){ record(GLCall_CompileShader); }
+static void GLAPIENTRY recordGetShaderiv(GLuint, GLenum pname, GLint* param){
+	record(GLCall_GetShaderiv);
+	*param = (pname == GL_COMPILE_STATUS || pname == GL_COMPLETION_STATUS_KHR) ? GL_TRUE : 0;
+}
+static void GLAPIENTRY recordGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog){
+	record(GLCall_GetShaderInfoLog);
+	if(length){
+		*length = 0;
+	}
+	if(bufSize > 0){
+		infoLog[0] = '\0';
+	}
+}
+static GLuint GLAPIENTRY recordCreateProgram(){ record(GLCall_CreateProgram); return nextName++; }
+static void GLAPIENTRY recordDeleteProgram(GLuint){ record(GLCall_DeleteProgram); }
+static void GLAPIENTRY recordAttachShader(GLuint, GLuint){ record(GLCall_AttachShader); }
+static void GLAPIENTRY recordBindAttribLocation(GLuint, GLuint, const GLchar*){ record(GLCall_BindAttribLocation); }
+static void GLAPIENTRY recordLinkProgram(GLuint){ record(GLCall_LinkProgram); }
+static void GLAPIENTRY recordGetProgramiv(GLuint, GLenum pname, GLint* param){
+	record(GLCall_GetProgramiv);
+	*param = (pname == GL_LINK_STATUS || pname == GL_COMPLETION_STATUS_KHR) ? GL_TRUE : 0;
+}
+static void GLAPIENTRY recordGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog){
+	record(GLCall_GetProgramInfoLog);
+	if(length){
+		*length = 0;
+	}
+	if(bufSize > 0){
+		infoLog[0] = '\0';
+	}
+}
+static void GLAPIENTRY recordUseProgram(GLuint){ recordState(GLCall_UseProgram); }
+static GLint GLAPIENTRY recordGetUniformLocation(GLuint, const GLchar*){
+	record(GLCall_GetUniformLocation);
+	return nextUniformLocation++;
+}
+static GLuint GLAPIENTRY recordGetUniformBlockIndex(GLuint, const GLchar*){
+	record(GLCall_GetUniformBlockIndex);
+	return 0;
+}
+static void GLAPIENTRY recordUniformBlockBinding(GLuint, GLuint, GLuint){ record(GLCall_UniformBlockBinding); }
+
+//uniforms
+static void GLAPIENTRY recordUniform1i(GLint, GLint){ recordUniform(GLCall_Uniform1i, sizeof(GLint)); }
+static void GLAPIENTRY recordUniform1f(GLint, GLfloat){ recordUniform(GLCall_Uniform1f, sizeof(GLfloat)); }
+static void GLAPIENTRY recordUniform3f(GLint, GLfloat, GLfloat, GLfloat){ recordUniform(GLCall_Uniform3f, 3 * sizeof(GLfloat)); }
+static void GLAPIENTRY recordUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat){ recordUniform(GLCall_Uniform4f, 4 * sizeof(GLfloat)); }
+static void GLAPIENTRY recordUniform3fv(GLint, GLsizei count, const GLfloat*){ recordUniform(GLCall_Uniform3fv, count * 3 * sizeof(GLfloat)); }
+static void GLAPIENTRY recordUniform4fv(GLint, GLsizei count, const GLfloat*){ recordUniform(GLCall_Uniform4fv, count * 4 * sizeof(GLfloat)); }
+static void GLAPIENTRY recordUniformMatrix4fv(GLint, GLsizei count, GLboolean, const GLfloat*){ recordUniform(GLCall_UniformMatrix4fv, count * 16 * sizeof(GLfloat)); }
+
+const char* glCallName(GLCall call){
+	static const char* names[] = {
+#define X(name) "gl" #name,
+		RECORDED_GL_CALLS(X)
+#undef X
+	};
+	return call < GLCall_Count ? names[call] : "unknown";
+}
+
+void installRecordingGL(){
+#ifndef __EMSCRIPTEN__
+	nativeGetIntegerv = glGetIntegerv;
+#define X(name) gl##name = record##name;
+	RECORDED_GL_CALLS(X)
+#undef X
+	recording = true;
+#endif
+}
+
+bool isRecordingGL(){
+	return recording;
+}
+
+void endGLFrame(){
+	lastFrame = currentFrame;
+	memset(&currentFrame, 0, sizeof(currentFrame));
+	frameNumber++;
+}
+
+const GLFrameStats& lastGLFrameStats(){
+	return lastFrame;
+}
+
+void printGLFrameStats(){
+	printf("frame %u: %u calls, %u draws, %u state changes, %u buffer bytes, %u uniform bytes\n",
+		frameNumber, lastFrame.totalCalls, lastFrame.drawCalls, lastFrame.stateChanges,
+		(unsigned int)lastFrame.bufferBytes, (unsigned int)lastFrame.uniformBytes);
+	for(int i=0;i<GLCall_Count;i++){
+		if(lastFrame.calls[i] > 0){
+			printf("\t%-28s %u\n", glCallName(GLCall(i)), lastFrame.calls[i]);
+		}
+	}
+}
@@ -0,0 +1,75 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "gldispatch.h"
+#include <cstddef>
+
+//Every OpenGL call the recording backend knows how to stand in for
+#define RECORDED_GL_CALLS(X) \
+	X(Clear) X(ClearColor) X(Enable) X(Disable) X(Viewport) \
+	X(DepthFunc) X(DepthMask) X(ColorMask) X(BlendFunc) X(CullFace) \
+	X(DrawArrays) X(DrawElements) X(DrawArraysInstanced) X(DrawElementsInstanced) X(MultiDrawElementsIndirect) \
+	X(GetString) X(GetIntegerv) X(GetError) X(Flush) X(Finish) \
+	X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) X(BufferData) X(BufferSubData) \
+	X(BufferStorage) X(MapBufferRange) X(FlushMappedBufferRange) X(UnmapBuffer) \
+	X(FenceSync) X(ClientWaitSync) X(DeleteSync) \
+	X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) \
+	X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribDivisor) \
+	X(CreateShader) X(DeleteShader) X(ShaderSource) X(CompileShader) X(GetShaderiv) X(GetShaderInfoLog) \
+	X(CreateProgram) X(DeleteProgram) X(AttachShader) X(BindAttribLocation) X(LinkProgram) \
+	X(GetProgramiv) X(GetProgramInfoLog) X(UseProgram) X(GetUniformLocation) \
+	X(GetUniformBlockIndex) X(UniformBlockBinding) \
+	X(Uniform1i) X(Uniform1f) X(Uniform3f) X(Uniform4f) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix4fv)
+
+enum GLCall {
+#define X(name) GLCall_##name,
+	RECORDED_GL_CALLS(X)
+#undef X
+	GLCall_Count
+};
+
+const char* glCallName(GLCall call);
+
+struct GLFrameStats {
+	unsigned int calls[GLCall_Count];
+	unsigned int totalCalls;
+	unsigned int drawCalls;
+	//binds, enables and anything else that changes what later calls do
+	unsigned int stateChanges;
+	//glBufferData/glBufferSubData/glBufferStorage payloads and flushed ranges of mapped buffers
+	size_t bufferBytes;
+	//glUniform* payloads
+	size_t uniformBytes;
+};
+
+//Replaces every recorded OpenGL entry point with a no-op that only counts the call
+//	There needs to be a current context when this is called, loadGL has to have run first.
+//	Object creation and compile/link queries still succeed so the demos run unchanged.
+void installRecordingGL();
+bool isRecordingGL();
+
+//Closes out the current frame's counters
+void endGLFrame();
+//Counters of the last completed frame
+const GLFrameStats& lastGLFrameStats();
+//Prints the last completed frame, only calls that were actually made are listed
+void printGLFrameStats();
@@ -0,0 +1,255 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "glstatecache.h"
+#include <cstdio>
+#include <cstring>
+
+static bool caching = false;
+static GLStateCacheStats currentFrame;
+static GLStateCacheStats lastFrame;
+
+//the calls the cache stands in front of, and whatever was installed before it
+#define CACHED_GL_CALLS(X) \
+	X(ClearColor) X(Enable) X(Disable) X(Viewport) X(DepthFunc) X(DepthMask) X(ColorMask) \
+	X(BlendFunc) X(CullFace) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) X(DeleteBuffers) X(BindVertexArray) X(DeleteVertexArrays) \
+	X(UseProgram) X(DeleteProgram)
+#define X(name) static decltype(gl##name) next##name;
+CACHED_GL_CALLS(X)
+#undef X
+
+//Any cached value can be unknown, either before its first call or after an invalidate
+template<class T>
+struct Cached {
+	T value;
+	bool known;
+	//returns true if the call has to go through
+	bool set(T v){
+		if(known && value == v){
+			return false;
+		}
+		value = v;
+		known = true;
+		return true;
+	}
+	bool is(T v){
+		return known && value == v;
+	}
+};
+
+struct Color {
+	GLfloat r, g, b, a;
+	bool operator==(const Color& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+struct Rect {
+	GLint x, y;
+	GLsizei w, h;
+	bool operator==(const Rect& o) const { return x == o.x && y == o.y && w == o.w && h == o.h; }
+};
+struct Mask {
+	GLboolean r, g, b, a;
+	bool operator==(const Mask& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+struct BlendFactors {
+	GLenum source, destination;
+	bool operator==(const BlendFactors& o) const { return source == o.source && destination == o.destination; }
+};
+
+static const GLenum cachedCapabilities[] = {GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+static const int capabilityCount = sizeof(cachedCapabilities)/sizeof(cachedCapabilities[0]);
+static const GLenum cachedBufferTargets[] = {GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+	GL_DRAW_INDIRECT_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER};
+static const int bufferTargetCount = sizeof(cachedBufferTargets)/sizeof(cachedBufferTargets[0]);
+//the element array binding belongs to the vertex array object
+static const int elementArrayTarget = 1;
+
+static struct {
+	Cached<Color> clearColor;
+	Cached<bool> capabilities[capabilityCount];
+	Cached<Rect> viewport;
+	Cached<GLenum> depthFunc;
+	Cached<GLboolean> depthMask;
+	Cached<Mask> colorMask;
+	Cached<BlendFactors> blendFunc;
+	Cached<GLenum> cullFace;
+	Cached<GLuint> buffers[bufferTargetCount];
+	Cached<GLuint> vertexArray;
+	Cached<GLuint> program;
+} state;
+
+static inline void elide(GLCall call){
+	currentFrame.elided[call]++;
+	currentFrame.totalElided++;
+}
+static int capabilityIndex(GLenum cap){
+	for(int i=0;i<capabilityCount;i++){
+		if(cachedCapabilities[i] == cap){
+			return i;
+		}
+	}
+	return -1;
+}
+static int bufferTargetIndex(GLenum target){
+	for(int i=0;i<bufferTargetCount;i++){
+		if(cachedBufferTargets[i] == target){
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void GLAPIENTRY cacheClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a){
+	if(state.clearColor.set(Color{r,g,b,a})) nextClearColor(r,g,b,a); else elide(GLCall_ClearColor);
+}
+static void GLAPIENTRY cacheEnable(GLenum cap){
+	int i = capabilityIndex(cap);
+	if(i < 0 || state.capabilities[i].set(true)) nextEnable(cap); else elide(GLCall_Enable);
+}
+static void GLAPIENTRY cacheDisable(GLenum cap){
+	int i = capabilityIndex(cap);
+	if(i < 0 || state.capabilities[i].set(false)) nextDisable(cap); else elide(GLCall_Disable);
+}
+static void GLAPIENTRY cacheViewport(GLint x, GLint y, GLsizei w, GLsizei h){
+	if(state.viewport.set(Rect{x,y,w,h})) nextViewport(x,y,w,h); else elide(GLCall_Viewport);
+}
+static void GLAPIENTRY cacheDepthFunc(GLenum func){
+	if(state.depthFunc.set(func)) nextDepthFunc(func); else elide(GLCall_DepthFunc);
+}
+static void GLAPIENTRY cacheDepthMask(GLboolean flag){
+	if(state.depthMask.set(flag)) nextDepthMask(flag); else elide(GLCall_DepthMask);
+}
+static void GLAPIENTRY cacheColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a){
+	if(state.colorMask.set(Mask{r,g,b,a})) nextColorMask(r,g,b,a); else elide(GLCall_ColorMask);
+}
+static void GLAPIENTRY cacheBlendFunc(GLenum s, GLenum d){
+	if(state.blendFunc.set(BlendFactors{s,d})) nextBlendFunc(s,d); else elide(GLCall_BlendFunc);
+}
+static void GLAPIENTRY cacheCullFace(GLenum mode){
+	if(state.cullFace.set(mode)) nextCullFace(mode); else elide(GLCall_CullFace);
+}
+static void GLAPIENTRY cacheBindBuffer(GLenum target, GLuint buffer){
+	int i = bufferTargetIndex(target);
+	if(i < 0 || state.buffers[i].set(buffer)) nextBindBuffer(target,buffer); else elide(GLCall_BindBuffer);
+}
+static void GLAPIENTRY cacheBindBufferBase(GLenum target, GLuint index, GLuint buffer){
+	//indexed bindings aren't cached, but this also binds the buffer to the generic target
+	int i = bufferTargetIndex(target);
+	if(i >= 0){
+		state.buffers[i].set(buffer);
+	}
+	nextBindBufferBase(target,index,buffer);
+}
+static void GLAPIENTRY cacheBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size){
+	int i = bufferTargetIndex(target);
+	if(i >= 0){
+		state.buffers[i].set(buffer);
+	}
+	nextBindBufferRange(target,index,buffer,offset,size);
+}
+static void GLAPIENTRY cacheDeleteBuffers(GLsizei n, const GLuint* buffers){
+	//deleting a bound buffer unbinds it
+	for(GLsizei b=0;b<n;b++){
+		for(int i=0;i<bufferTargetCount;i++){
+			if(buffers[b] != 0 && state.buffers[i].is(buffers[b])){
+				state.buffers[i].value = 0;
+			}
+		}
+	}
+	nextDeleteBuffers(n,buffers);
+}
+static void GLAPIENTRY cacheBindVertexArray(GLuint array){
+	if(state.vertexArray.set(array)){
+		state.buffers[elementArrayTarget].known = false;
+		nextBindVertexArray(array);
+	} else {
+		elide(GLCall_BindVertexArray);
+	}
+}
+static void GLAPIENTRY cacheDeleteVertexArrays(GLsizei n, const GLuint* arrays){
+	for(GLsizei a=0;a<n;a++){
+		if(arrays[a] != 0 && state.vertexArray.is(arrays[a])){
+			state.vertexArray.value = 0;
+			state.buffers[elementArrayTarget].known = false;
+		}
+	}
+	nextDeleteVertexArrays(n,arrays);
+}
+static void GLAPIENTRY cacheUseProgram(GLuint program){
+	if(state.program.set(program)) nextUseProgram(program); else elide(GLCall_UseProgram);
+}
+static void GLAPIENTRY cacheDeleteProgram(GLuint program){
+	//a deleted program stays in use until something else is, but don't count on its name
+	if(program != 0 && state.program.is(program)){
+		state.program.known = false;
+	}
+	nextDeleteProgram(program);
+}
+
+void installGLStateCache(){
+#ifndef __EMSCRIPTEN__
+	if(caching){
+		return;
+	}
+#define X(name) next##name = gl##name; gl##name = cache##name;
+	CACHED_GL_CALLS(X)
+#undef X
+	invalidateGLStateCache();
+	caching = true;
+#endif
+}
+
+void removeGLStateCache(){
+#ifndef __EMSCRIPTEN__
+	if(!caching){
+		return;
+	}
+#define X(name) gl##name = next##name;
+	CACHED_GL_CALLS(X)
+#undef X
+	caching = false;
+#endif
+}
+
+bool isCachingGLState(){
+	return caching;
+}
+
+void invalidateGLStateCache(){
+	memset(&state, 0, sizeof(state));
+}
+
+void endGLStateCacheFrame(){
+	lastFrame = currentFrame;
+	memset(&currentFrame, 0, sizeof(currentFrame));
+}
+
+const GLStateCacheStats& lastGLStateCacheStats(){
+	return lastFrame;
+}
+
+void printGLStateCacheStats(){
+	printf("%u redundant calls elided\n", lastFrame.totalElided);
+	for(int i=0;i<GLCall_Count;i++){
+		if(lastFrame.elided[i] > 0){
+			printf("\t%-28s %u\n", glCallName(GLCall(i)), lastFrame.elided[i]);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "glrecorder.h"
+
+//Shadow copy of the OpenGL state the demos change the most
+//	Installed over the current entry points (native, recording or tracing) it drops any
+//	bind, enable or state call that would set what is already set, so code like Geometry::draw
+//	and Shader::bind can bind unconditionally without paying for it.
+//	Everything starts out unknown, so the first call of each kind always goes through.
+//	Code that changes state without going through the gl* pointers (another library sharing
+//	the context, for example) has to call invalidateGLStateCache() afterwards.
+void installGLStateCache();
+//Puts back the entry points that were there before installGLStateCache()
+void removeGLStateCache();
+bool isCachingGLState();
+void invalidateGLStateCache();
+
+struct GLStateCacheStats {
+	//calls that were dropped because they wouldn't have changed anything
+	unsigned int elided[GLCall_Count];
+	unsigned int totalElided;
+};
+
+//Closes out the current frame's counters
+void endGLStateCacheFrame();
+//Counters of the last completed frame
+const GLStateCacheStats& lastGLStateCacheStats();
+void printGLStateCacheStats();
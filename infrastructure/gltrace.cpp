@@ -0,0 +1,917 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "gltrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char traceMagic[4] = {'G','L','T','R'};
+static const uint32_t traceVersion = 5;
+
+//////////////////////////////////////////////////////////////////////////
+// Capture
+//////////////////////////////////////////////////////////////////////////
+
+static FILE* traceFile = nullptr;
+static std::vector<char> traceBuffer;
+//pointer of the current mapping on each target, flushed ranges are copied into the trace from there
+static std::unordered_map<GLenum,char*> tracedMappings;
+
+//whatever was installed before tracing started
+#define X(name) static decltype(gl##name) native##name;
+RECORDED_GL_CALLS(X)
+#undef X
+
+template<class T>
+static inline void put(T value){
+	const char* bytes = (const char*)&value;
+	traceBuffer.insert(traceBuffer.end(), bytes, bytes + sizeof(T));
+}
+static inline void putOp(GLCall op){
+	put<uint16_t>(op);
+}
+static inline void putBytes(const void* data, size_t size){
+	put<uint32_t>((uint32_t)size);
+	if(size > 0){
+		traceBuffer.insert(traceBuffer.end(), (const char*)data, (const char*)data + size);
+	}
+}
+static inline void putString(const char* string){
+	putBytes(string, strlen(string));
+}
+static void flushTrace(){
+	if(traceFile && !traceBuffer.empty()){
+		fwrite(traceBuffer.data(), 1, traceBuffer.size(), traceFile);
+		traceBuffer.clear();
+	}
+}
+
+static void GLAPIENTRY traceClear(GLbitfield mask){ putOp(GLCall_Clear); put(mask); nativeClear(mask); }
+static void GLAPIENTRY traceClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a){
+	putOp(GLCall_ClearColor); put(r); put(g); put(b); put(a);
+	nativeClearColor(r,g,b,a);
+}
+static void GLAPIENTRY traceEnable(GLenum cap){ putOp(GLCall_Enable); put(cap); nativeEnable(cap); }
+static void GLAPIENTRY traceDisable(GLenum cap){ putOp(GLCall_Disable); put(cap); nativeDisable(cap); }
+static void GLAPIENTRY traceViewport(GLint x, GLint y, GLsizei w, GLsizei h){
+	putOp(GLCall_Viewport); put(x); put(y); put(w); put(h);
+	nativeViewport(x,y,w,h);
+}
+static void GLAPIENTRY traceDepthFunc(GLenum func){ putOp(GLCall_DepthFunc); put(func); nativeDepthFunc(func); }
+static void GLAPIENTRY traceDepthMask(GLboolean flag){ putOp(GLCall_DepthMask); put(flag); nativeDepthMask(flag); }
+static void GLAPIENTRY traceColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a){
+	putOp(GLCall_ColorMask); put(r); put(g); put(b); put(a);
+	nativeColorMask(r,g,b,a);
+}
+static void GLAPIENTRY traceBlendFunc(GLenum s, GLenum d){ putOp(GLCall_BlendFunc); put(s); put(d); nativeBlendFunc(s,d); }
+static void GLAPIENTRY traceCullFace(GLenum mode){ putOp(GLCall_CullFace); put(mode); nativeCullFace(mode); }
+static void GLAPIENTRY traceDrawArrays(GLenum mode, GLint first, GLsizei count){
+	putOp(GLCall_DrawArrays); put(mode); put(first); put(count);
+	nativeDrawArrays(mode,first,count);
+}
+static void GLAPIENTRY traceDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices){
+	//indices are always an offset into the bound element buffer in the demos
+	putOp(GLCall_DrawElements); put(mode); put(count); put(type); put<uint64_t>((uintptr_t)indices);
+	nativeDrawElements(mode,count,type,indices);
+}
+static void GLAPIENTRY traceDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount){
+	putOp(GLCall_DrawArraysInstanced); put(mode); put(first); put(count); put(primcount);
+	nativeDrawArraysInstanced(mode,first,count,primcount);
+}
+static void GLAPIENTRY traceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei primcount){
+	putOp(GLCall_DrawElementsInstanced); put(mode); put(count); put(type); put<uint64_t>((uintptr_t)indices); put(primcount);
+	nativeDrawElementsInstanced(mode,count,type,indices,primcount);
+}
+static void GLAPIENTRY traceMultiDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid* indirect, GLsizei drawcount, GLsizei stride){
+	//indirect is always an offset into the bound draw indirect buffer in the demos
+	putOp(GLCall_MultiDrawElementsIndirect); put(mode); put(type); put<uint64_t>((uintptr_t)indirect); put(drawcount); put(stride);
+	nativeMultiDrawElementsIndirect(mode,type,indirect,drawcount,stride);
+}
+static const GLubyte* GLAPIENTRY traceGetString(GLenum name){ putOp(GLCall_GetString); put(name); return nativeGetString(name); }
+static void GLAPIENTRY traceGetIntegerv(GLenum pname, GLint* params){ putOp(GLCall_GetIntegerv); put(pname); nativeGetIntegerv(pname,params); }
+static GLenum GLAPIENTRY traceGetError(){ putOp(GLCall_GetError); return nativeGetError(); }
+static void GLAPIENTRY traceFlush(){ putOp(GLCall_Flush); nativeFlush(); }
+static void GLAPIENTRY traceFinish(){ putOp(GLCall_Finish); nativeFinish(); }
+
+static void GLAPIENTRY traceGenBuffers(GLsizei n, GLuint* buffers){
+	nativeGenBuffers(n,buffers);
+	putOp(GLCall_GenBuffers); putBytes(buffers, n * sizeof(GLuint));
+}
+static void GLAPIENTRY traceDeleteBuffers(GLsizei n, const GLuint* buffers){
+	putOp(GLCall_DeleteBuffers); putBytes(buffers, n * sizeof(GLuint));
+	nativeDeleteBuffers(n,buffers);
+}
+static void GLAPIENTRY traceBindBuffer(GLenum target, GLuint buffer){
+	putOp(GLCall_BindBuffer); put(target); put(buffer);
+	nativeBindBuffer(target,buffer);
+}
+static void GLAPIENTRY traceBindBufferBase(GLenum target, GLuint index, GLuint buffer){
+	putOp(GLCall_BindBufferBase); put(target); put(index); put(buffer);
+	nativeBindBufferBase(target,index,buffer);
+}
+static void GLAPIENTRY traceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size){
+	putOp(GLCall_BindBufferRange); put(target); put(index); put(buffer); put<int64_t>(offset); put<int64_t>(size);
+	nativeBindBufferRange(target,index,buffer,offset,size);
+}
+static void GLAPIENTRY traceBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage){
+	putOp(GLCall_BufferData); put(target); put<int64_t>(size); put(usage);
+	putBytes(data, data ? size : 0);
+	nativeBufferData(target,size,data,usage);
+}
+static void GLAPIENTRY traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data){
+	putOp(GLCall_BufferSubData); put(target); put<int64_t>(offset);
+	putBytes(data, size);
+	nativeBufferSubData(target,offset,size,data);
+}
+static void GLAPIENTRY traceBufferStorage(GLenum target, GLsizeiptr size, const GLvoid* data, GLbitfield flags){
+	putOp(GLCall_BufferStorage); put(target); put<int64_t>(size); put(flags);
+	putBytes(data, data ? size : 0);
+	nativeBufferStorage(target,size,data,flags);
+}
+//writes through a mapping can't be seen, so the trace only holds what reaches the GPU through glFlushMappedBufferRange
+//	Buffers have to be mapped with GL_MAP_FLUSH_EXPLICIT_BIT for a trace of them to replay correctly.
+static GLvoid* GLAPIENTRY traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access){
+	putOp(GLCall_MapBufferRange); put(target); put<int64_t>(offset); put<int64_t>(length); put(access);
+	GLvoid* pointer = nativeMapBufferRange(target,offset,length,access);
+	tracedMappings[target] = (char*)pointer;
+	return pointer;
+}
+static void GLAPIENTRY traceFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length){
+	putOp(GLCall_FlushMappedBufferRange); put(target); put<int64_t>(offset);
+	auto mapped = tracedMappings.find(target);
+	if(mapped != tracedMappings.end() && mapped->second){
+		putBytes(mapped->second + offset, length);
+	} else {
+		putBytes(nullptr, 0);
+	}
+	nativeFlushMappedBufferRange(target,offset,length);
+}
+static GLboolean GLAPIENTRY traceUnmapBuffer(GLenum target){
+	putOp(GLCall_UnmapBuffer); put(target);
+	tracedMappings.erase(target);
+	return nativeUnmapBuffer(target);
+}
+static GLsync GLAPIENTRY traceFenceSync(GLenum condition, GLbitfield flags){
+	GLsync sync = nativeFenceSync(condition,flags);
+	putOp(GLCall_FenceSync); put(condition); put(flags); put<uint64_t>((uintptr_t)sync);
+	return sync;
+}
+static GLenum GLAPIENTRY traceClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout){
+	putOp(GLCall_ClientWaitSync); put<uint64_t>((uintptr_t)sync); put(flags); put<uint64_t>(timeout);
+	return nativeClientWaitSync(sync,flags,timeout);
+}
+static void GLAPIENTRY traceDeleteSync(GLsync sync){
+	putOp(GLCall_DeleteSync); put<uint64_t>((uintptr_t)sync);
+	nativeDeleteSync(sync);
+}
+static void GLAPIENTRY traceGenVertexArrays(GLsizei n, GLuint* arrays){
+	nativeGenVertexArrays(n,arrays);
+	putOp(GLCall_GenVertexArrays); putBytes(arrays, n * sizeof(GLuint));
+}
+static void GLAPIENTRY traceDeleteVertexArrays(GLsizei n, const GLuint* arrays){
+	putOp(GLCall_DeleteVertexArrays); putBytes(arrays, n * sizeof(GLuint));
+	nativeDeleteVertexArrays(n,arrays);
+}
+static void GLAPIENTRY traceBindVertexArray(GLuint array){ putOp(GLCall_BindVertexArray); put(array); nativeBindVertexArray(array); }
+static void GLAPIENTRY traceEnableVertexAttribArray(GLuint index){ putOp(GLCall_EnableVertexAttribArray); put(index); nativeEnableVertexAttribArray(index); }
+static void GLAPIENTRY traceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer){
+	//always an offset into the bound array buffer in the demos
+	putOp(GLCall_VertexAttribPointer); put(index); put(size); put(type); put(normalized); put(stride); put<uint64_t>((uintptr_t)pointer);
+	nativeVertexAttribPointer(index,size,type,normalized,stride,pointer);
+}
+static void GLAPIENTRY traceVertexAttribDivisor(GLuint index, GLuint divisor){
+	putOp(GLCall_VertexAttribDivisor); put(index); put(divisor);
+	nativeVertexAttribDivisor(index,divisor);
+}
+
+static GLuint GLAPIENTRY traceCreateShader(GLenum type){
+	GLuint shader = nativeCreateShader(type);
+	putOp(GLCall_CreateShader); put(type); put(shader);
+	return shader;
+}
+static void GLAPIENTRY traceDeleteShader(GLuint shader){ putOp(GLCall_DeleteShader); put(shader); nativeDeleteShader(shader); }
+static void GLAPIENTRY traceShaderSource(GLuint shader, GLsizei count, const GLchar** strings, const GLint* lengths){
+	putOp(GLCall_ShaderSource); put(shader); put(count);
+	for(GLsizei i=0;i<count;i++){
+		putBytes(strings[i], (lengths && lengths[i] >= 0) ? lengths[i] : strlen(strings[i]));
+	}
+	nativeShaderSource(shader,count,strings,lengths);
+}
+static void GLAPIENTRY traceCompileShader(GLuint shader){ putOp(GLCall_CompileShader); put(shader); nativeCompileShader(shader); }
+static void GLAPIENTRY traceGetShaderiv(GLuint shader, GLenum pname, GLint* param){
+	putOp(GLCall_GetShaderiv); put(shader); put(pname);
+	nativeGetShaderiv(shader,pname,param);
+}
+static void GLAPIENTRY traceGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog){
+	putOp(GLCall_GetShaderInfoLog); put(shader); put(bufSize);
+	nativeGetShaderInfoLog(shader,bufSize,length,infoLog);
+}
+static GLuint GLAPIENTRY traceCreateProgram(){
+	GLuint program = nativeCreateProgram();
+	putOp(GLCall_CreateProgram); put(program);
+	return program;
+}
+static void GLAPIENTRY traceDeleteProgram(GLuint program){ putOp(GLCall_DeleteProgram); put(program); nativeDeleteProgram(program); }
+static void GLAPIENTRY traceAttachShader(GLuint program, GLuint shader){
+	putOp(GLCall_AttachShader); put(program); put(shader);
+	nativeAttachShader(program,shader);
+}
+static void GLAPIENTRY traceBindAttribLocation(GLuint program, GLuint index, const GLchar* name){
+	putOp(GLCall_BindAttribLocation); put(program); put(index); putString(name);
+	nativeBindAttribLocation(program,index,name);
+}
+static void GLAPIENTRY traceLinkProgram(GLuint program){ putOp(GLCall_LinkProgram); put(program); nativeLinkProgram(program); }
+static void GLAPIENTRY traceGetProgramiv(GLuint program, GLenum pname, GLint* param){
+	putOp(GLCall_GetProgramiv); put(program); put(pname);
+	nativeGetProgramiv(program,pname,param);
+}
+static void GLAPIENTRY traceGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog){
+	putOp(GLCall_GetProgramInfoLog); put(program); put(bufSize);
+	nativeGetProgramInfoLog(program,bufSize,length,infoLog);
+}
+static void GLAPIENTRY traceUseProgram(GLuint program){ putOp(GLCall_UseProgram); put(program); nativeUseProgram(program); }
+static GLint GLAPIENTRY traceGetUniformLocation(GLuint program, const GLchar* name){
+	GLint location = nativeGetUniformLocation(program,name);
+	putOp(GLCall_GetUniformLocation); put(program); putString(name); put(location);
+	return location;
+}
+static GLuint GLAPIENTRY traceGetUniformBlockIndex(GLuint program, const GLchar* name){
+	putOp(GLCall_GetUniformBlockIndex); put(program); putString(name);
+	return nativeGetUniformBlockIndex(program,name);
+}
+static void GLAPIENTRY traceUniformBlockBinding(GLuint program, GLuint block, GLuint binding){
+	putOp(GLCall_UniformBlockBinding); put(program); put(block); put(binding);
+	nativeUniformBlockBinding(program,block,binding);
+}
+
+static void GLAPIENTRY traceUniform1i(GLint location, GLint v0){ putOp(GLCall_Uniform1i); put(location); put(v0); nativeUniform1i(location,v0); }
+static void GLAPIENTRY traceUniform1f(GLint location, GLfloat v0){ putOp(GLCall_Uniform1f); put(location); put(v0); nativeUniform1f(location,v0); }
+static void GLAPIENTRY traceUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2){
+	putOp(GLCall_Uniform3f); put(location); put(v0); put(v1); put(v2);
+	nativeUniform3f(location,v0,v1,v2);
+}
+static void GLAPIENTRY traceUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3){
+	putOp(GLCall_Uniform4f); put(location); put(v0); put(v1); put(v2); put(v3);
+	nativeUniform4f(location,v0,v1,v2,v3);
+}
+static void GLAPIENTRY traceUniform3fv(GLint location, GLsizei count, const GLfloat* value){
+	putOp(GLCall_Uniform3fv); put(location); putBytes(value, count * 3 * sizeof(GLfloat));
+	nativeUniform3fv(location,count,value);
+}
+static void GLAPIENTRY traceUniform4fv(GLint location, GLsizei count, const GLfloat* value){
+	putOp(GLCall_Uniform4fv); put(location); putBytes(value, count * 4 * sizeof(GLfloat));
+	nativeUniform4fv(location,count,value);
+}
+static void GLAPIENTRY traceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value){
+	putOp(GLCall_UniformMatrix4fv); put(location); put(transpose); putBytes(value, count * 16 * sizeof(GLfloat));
+	nativeUniformMatrix4fv(location,count,transpose,value);
+}
+
+bool startGLTrace(std::string filename){
+#ifdef __EMSCRIPTEN__
+	return false;
+#else
+	if(traceFile){
+		return false;
+	}
+	traceFile = fopen(filename.c_str(), "wb");
+	if(!traceFile){
+		printf("couldn't open %s for the GL trace\n", filename.c_str());
+		return false;
+	}
+	fwrite(traceMagic, 1, sizeof(traceMagic), traceFile);
+	fwrite(&traceVersion, sizeof(traceVersion), 1, traceFile);
+#define X(name) native##name = gl##name; gl##name = trace##name;
+	RECORDED_GL_CALLS(X)
+#undef X
+	//the demos never shut down cleanly, so make sure the tail of the trace makes it to disk
+	atexit(stopGLTrace);
+	return true;
+#endif
+}
+
+void stopGLTrace(){
+#ifndef __EMSCRIPTEN__
+	if(!traceFile){
+		return;
+	}
+#define X(name) gl##name = native##name;
+	RECORDED_GL_CALLS(X)
+#undef X
+	flushTrace();
+	fclose(traceFile);
+	traceFile = nullptr;
+#endif
+}
+
+bool isTracingGL(){
+	return traceFile != nullptr;
+}
+
+void markGLTraceFrame(){
+	if(!traceFile){
+		return;
+	}
+	put<uint16_t>(GLTraceEndFrame);
+	flushTrace();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Replay
+//////////////////////////////////////////////////////////////////////////
+
+GLTraceReplay::GLTraceReplay(std::unique_ptr<FileView> contents) : data(std::move(contents)) {
+	position = sizeof(traceMagic) + sizeof(traceVersion);
+	firstFrame = 0;
+	lastFrameEnd = 0;
+	scanning = false;
+	currentProgram = 0;
+	memset(timings.calls, 0, sizeof(timings.calls));
+	memset(timings.nanoseconds, 0, sizeof(timings.nanoseconds));
+}
+
+std::unique_ptr<GLTraceReplay> GLTraceReplay::Create(std::string filename){
+	//traces run to hundreds of megabytes, mapped they are paged in as the replay gets to them
+	std::unique_ptr<FileView> contents = FileView::Create(filename);
+	if(!contents){
+		printf("couldn't open %s\n", filename.c_str());
+		return std::unique_ptr<GLTraceReplay>();
+	}
+	uint32_t version = 0;
+	if(contents->size() < sizeof(traceMagic) + sizeof(version) || memcmp(contents->data(), traceMagic, sizeof(traceMagic)) != 0){
+		printf("%s isn't a GL trace\n", filename.c_str());
+		return std::unique_ptr<GLTraceReplay>();
+	}
+	memcpy(&version, contents->data() + sizeof(traceMagic), sizeof(version));
+	if(version != traceVersion){
+		printf("%s is trace version %u, expected %u\n", filename.c_str(), version, traceVersion);
+		return std::unique_ptr<GLTraceReplay>();
+	}
+	std::unique_ptr<GLTraceReplay> replay(new GLTraceReplay(std::move(contents)));
+	replay->findFrames();
+	return replay;
+}
+
+//The calls have different sizes, so the markers are found by decoding the whole trace once
+//	Nothing is called and nothing timed, and the names the decoding made up are forgotten again.
+void GLTraceReplay::findFrames(){
+	scanning = true;
+	while(position + sizeof(uint16_t) <= data->size()){
+		uint16_t op;
+		memcpy(&op, data->data() + position, sizeof(op));
+		position += sizeof(op);
+		if(op == GLTraceEndFrame){
+			if(firstFrame == 0){
+				firstFrame = position;
+			}
+			lastFrameEnd = position;
+		} else if(!playCall(op)){
+			break;
+		}
+	}
+	//a trace without markers is one long frame
+	if(lastFrameEnd == 0){
+		lastFrameEnd = data->size();
+	}
+	scanning = false;
+	position = sizeof(traceMagic) + sizeof(traceVersion);
+	buffers.clear();
+	vertexArrays.clear();
+	shaderObjects.clear();
+	uniformLocations.clear();
+	syncs.clear();
+	mappedRanges.clear();
+	currentProgram = 0;
+}
+
+//reads values back in the order the capture wrote them
+class TraceReader {
+private:
+	const FileView& data;
+	size_t& position;
+public:
+	bool overrun;
+	TraceReader(const FileView& data, size_t& position) : data(data), position(position), overrun(false) {}
+	template<class T>
+	T get(){
+		T value = T();
+		if(position + sizeof(T) > data.size()){
+			overrun = true;
+			return value;
+		}
+		memcpy(&value, data.data() + position, sizeof(T));
+		position += sizeof(T);
+		return value;
+	}
+	//returns a pointer into the trace and its length
+	const char* getBytes(uint32_t& size){
+		size = get<uint32_t>();
+		if(position + size > data.size()){
+			overrun = true;
+			size = 0;
+			return nullptr;
+		}
+		const char* bytes = data.data() + position;
+		position += size;
+		return bytes;
+	}
+	std::string getString(){
+		uint32_t size;
+		const char* bytes = getBytes(size);
+		return std::string(bytes ? bytes : "", size);
+	}
+};
+
+static GLuint lookup(const std::unordered_map<GLuint,GLuint>& names, GLuint traced){
+	auto it = names.find(traced);
+	return it == names.end() ? traced : it->second;
+}
+
+bool GLTraceReplay::playCall(uint16_t op){
+	TraceReader in(*data, position);
+	//arguments are decoded first so only the call itself is timed
+	auto start = std::chrono::high_resolution_clock::now();
+#define TIMED(call) if(!scanning){ start = std::chrono::high_resolution_clock::now(); call; }
+	switch(op){
+	case GLCall_Clear: { GLbitfield mask = in.get<GLbitfield>(); TIMED(glClear(mask)); break; }
+	case GLCall_ClearColor: {
+		GLclampf r = in.get<GLclampf>(), g = in.get<GLclampf>(), b = in.get<GLclampf>(), a = in.get<GLclampf>();
+		TIMED(glClearColor(r,g,b,a));
+		break;
+	}
+	case GLCall_Enable: { GLenum cap = in.get<GLenum>(); TIMED(glEnable(cap)); break; }
+	case GLCall_Disable: { GLenum cap = in.get<GLenum>(); TIMED(glDisable(cap)); break; }
+	case GLCall_Viewport: {
+		GLint x = in.get<GLint>(), y = in.get<GLint>();
+		GLsizei w = in.get<GLsizei>(), h = in.get<GLsizei>();
+		TIMED(glViewport(x,y,w,h));
+		break;
+	}
+	case GLCall_DepthFunc: { GLenum func = in.get<GLenum>(); TIMED(glDepthFunc(func)); break; }
+	case GLCall_DepthMask: { GLboolean flag = in.get<GLboolean>(); TIMED(glDepthMask(flag)); break; }
+	case GLCall_ColorMask: {
+		GLboolean r = in.get<GLboolean>(), g = in.get<GLboolean>(), b = in.get<GLboolean>(), a = in.get<GLboolean>();
+		TIMED(glColorMask(r,g,b,a));
+		break;
+	}
+	case GLCall_BlendFunc: { GLenum s = in.get<GLenum>(), d = in.get<GLenum>(); TIMED(glBlendFunc(s,d)); break; }
+	case GLCall_CullFace: { GLenum mode = in.get<GLenum>(); TIMED(glCullFace(mode)); break; }
+	case GLCall_DrawArrays: {
+		GLenum mode = in.get<GLenum>();
+		GLint first = in.get<GLint>();
+		GLsizei count = in.get<GLsizei>();
+		TIMED(glDrawArrays(mode,first,count));
+		break;
+	}
+	case GLCall_DrawElements: {
+		GLenum mode = in.get<GLenum>();
+		GLsizei count = in.get<GLsizei>();
+		GLenum type = in.get<GLenum>();
+		const GLvoid* indices = (const GLvoid*)(uintptr_t)in.get<uint64_t>();
+		TIMED(glDrawElements(mode,count,type,indices));
+		break;
+	}
+	case GLCall_DrawArraysInstanced: {
+		GLenum mode = in.get<GLenum>();
+		GLint first = in.get<GLint>();
+		GLsizei count = in.get<GLsizei>();
+		GLsizei primcount = in.get<GLsizei>();
+		TIMED(glDrawArraysInstanced(mode,first,count,primcount));
+		break;
+	}
+	case GLCall_DrawElementsInstanced: {
+		GLenum mode = in.get<GLenum>();
+		GLsizei count = in.get<GLsizei>();
+		GLenum type = in.get<GLenum>();
+		const GLvoid* indices = (const GLvoid*)(uintptr_t)in.get<uint64_t>();
+		GLsizei primcount = in.get<GLsizei>();
+		TIMED(glDrawElementsInstanced(mode,count,type,indices,primcount));
+		break;
+	}
+	case GLCall_MultiDrawElementsIndirect: {
+		GLenum mode = in.get<GLenum>();
+		GLenum type = in.get<GLenum>();
+		const GLvoid* indirect = (const GLvoid*)(uintptr_t)in.get<uint64_t>();
+		GLsizei drawcount = in.get<GLsizei>();
+		GLsizei stride = in.get<GLsizei>();
+		TIMED(glMultiDrawElementsIndirect(mode,type,indirect,drawcount,stride));
+		break;
+	}
+	case GLCall_GetString: { GLenum name = in.get<GLenum>(); TIMED(glGetString(name)); break; }
+	case GLCall_GetIntegerv: { GLenum pname = in.get<GLenum>(); GLint value; TIMED(glGetIntegerv(pname,&value)); break; }
+	case GLCall_GetError: { TIMED(glGetError()); break; }
+	case GLCall_Flush: { TIMED(glFlush()); break; }
+	case GLCall_Finish: { TIMED(glFinish()); break; }
+	case GLCall_GenBuffers: {
+		uint32_t size;
+		const GLuint* traced = (const GLuint*)in.getBytes(size);
+		std::vector<GLuint> generated(size / sizeof(GLuint));
+		TIMED(glGenBuffers(GLsizei(generated.size()), generated.data()));
+		for(size_t i=0;i<generated.size();i++){
+			buffers[traced[i]] = generated[i];
+		}
+		break;
+	}
+	case GLCall_DeleteBuffers: {
+		uint32_t size;
+		const GLuint* traced = (const GLuint*)in.getBytes(size);
+		std::vector<GLuint> replayed(size / sizeof(GLuint));
+		for(size_t i=0;i<replayed.size();i++){
+			replayed[i] = lookup(buffers, traced[i]);
+		}
+		TIMED(glDeleteBuffers(GLsizei(replayed.size()), replayed.data()));
+		break;
+	}
+	case GLCall_BindBuffer: {
+		GLenum target = in.get<GLenum>();
+		GLuint buffer = lookup(buffers, in.get<GLuint>());
+		TIMED(glBindBuffer(target,buffer));
+		break;
+	}
+	case GLCall_BindBufferBase: {
+		GLenum target = in.get<GLenum>();
+		GLuint index = in.get<GLuint>();
+		GLuint buffer = lookup(buffers, in.get<GLuint>());
+		TIMED(glBindBufferBase(target,index,buffer));
+		break;
+	}
+	case GLCall_BindBufferRange: {
+		GLenum target = in.get<GLenum>();
+		GLuint index = in.get<GLuint>();
+		GLuint buffer = lookup(buffers, in.get<GLuint>());
+		GLintptr offset = GLintptr(in.get<int64_t>());
+		GLsizeiptr size = GLsizeiptr(in.get<int64_t>());
+		TIMED(glBindBufferRange(target,index,buffer,offset,size));
+		break;
+	}
+	case GLCall_BufferData: {
+		GLenum target = in.get<GLenum>();
+		GLsizeiptr size = GLsizeiptr(in.get<int64_t>());
+		GLenum usage = in.get<GLenum>();
+		uint32_t payloadSize;
+		const char* payload = in.getBytes(payloadSize);
+		TIMED(glBufferData(target, size, payloadSize ? payload : nullptr, usage));
+		break;
+	}
+	case GLCall_BufferSubData: {
+		GLenum target = in.get<GLenum>();
+		GLintptr offset = GLintptr(in.get<int64_t>());
+		uint32_t size;
+		const char* payload = in.getBytes(size);
+		TIMED(glBufferSubData(target, offset, size, payload));
+		break;
+	}
+	case GLCall_BufferStorage: {
+		GLenum target = in.get<GLenum>();
+		GLsizeiptr size = GLsizeiptr(in.get<int64_t>());
+		GLbitfield flags = in.get<GLbitfield>();
+		uint32_t payloadSize;
+		const char* payload = in.getBytes(payloadSize);
+		TIMED(glBufferStorage(target, size, payloadSize ? payload : nullptr, flags));
+		break;
+	}
+	case GLCall_MapBufferRange: {
+		GLenum target = in.get<GLenum>();
+		GLintptr offset = GLintptr(in.get<int64_t>());
+		GLsizeiptr length = GLsizeiptr(in.get<int64_t>());
+		GLbitfield access = in.get<GLbitfield>();
+		GLvoid* pointer = nullptr;
+		TIMED(pointer = glMapBufferRange(target,offset,length,access));
+		mappedRanges[target] = (char*)pointer;
+		break;
+	}
+	//the traced bytes are written into this replay's own mapping before flushing them
+	case GLCall_FlushMappedBufferRange: {
+		GLenum target = in.get<GLenum>();
+		GLintptr offset = GLintptr(in.get<int64_t>());
+		uint32_t size;
+		const char* payload = in.getBytes(size);
+		auto mapped = mappedRanges.find(target);
+		if(mapped == mappedRanges.end() || !mapped->second){
+			break;
+		}
+		TIMED(memcpy(mapped->second + offset, payload, size); glFlushMappedBufferRange(target,offset,size));
+		break;
+	}
+	case GLCall_UnmapBuffer: {
+		GLenum target = in.get<GLenum>();
+		mappedRanges.erase(target);
+		TIMED(glUnmapBuffer(target));
+		break;
+	}
+	case GLCall_FenceSync: {
+		GLenum condition = in.get<GLenum>();
+		GLbitfield flags = in.get<GLbitfield>();
+		uint64_t traced = in.get<uint64_t>();
+		GLsync sync = nullptr;
+		TIMED(sync = glFenceSync(condition,flags));
+		syncs[traced] = sync;
+		break;
+	}
+	//waiting is timed too, it is how long the CPU got ahead of the GPU
+	case GLCall_ClientWaitSync: {
+		auto found = syncs.find(in.get<uint64_t>());
+		GLbitfield flags = in.get<GLbitfield>();
+		GLuint64 timeout = in.get<uint64_t>();
+		if(found == syncs.end()){
+			break;
+		}
+		TIMED(glClientWaitSync(found->second,flags,timeout));
+		break;
+	}
+	case GLCall_DeleteSync: {
+		auto found = syncs.find(in.get<uint64_t>());
+		if(found == syncs.end()){
+			break;
+		}
+		TIMED(glDeleteSync(found->second));
+		syncs.erase(found);
+		break;
+	}
+	case GLCall_GenVertexArrays: {
+		uint32_t size;
+		const GLuint* traced = (const GLuint*)in.getBytes(size);
+		std::vector<GLuint> generated(size / sizeof(GLuint));
+		TIMED(glGenVertexArrays(GLsizei(generated.size()), generated.data()));
+		for(size_t i=0;i<generated.size();i++){
+			vertexArrays[traced[i]] = generated[i];
+		}
+		break;
+	}
+	case GLCall_DeleteVertexArrays: {
+		uint32_t size;
+		const GLuint* traced = (const GLuint*)in.getBytes(size);
+		std::vector<GLuint> replayed(size / sizeof(GLuint));
+		for(size_t i=0;i<replayed.size();i++){
+			replayed[i] = lookup(vertexArrays, traced[i]);
+		}
+		TIMED(glDeleteVertexArrays(GLsizei(replayed.size()), replayed.data()));
+		break;
+	}
+	case GLCall_BindVertexArray: { GLuint array = lookup(vertexArrays, in.get<GLuint>()); TIMED(glBindVertexArray(array)); break; }
+	case GLCall_EnableVertexAttribArray: { GLuint index = in.get<GLuint>(); TIMED(glEnableVertexAttribArray(index)); break; }
+	case GLCall_VertexAttribPointer: {
+		GLuint index = in.get<GLuint>();
+		GLint size = in.get<GLint>();
+		GLenum type = in.get<GLenum>();
+		GLboolean normalized = in.get<GLboolean>();
+		GLsizei stride = in.get<GLsizei>();
+		const GLvoid* pointer = (const GLvoid*)(uintptr_t)in.get<uint64_t>();
+		TIMED(glVertexAttribPointer(index,size,type,normalized,stride,pointer));
+		break;
+	}
+	case GLCall_VertexAttribDivisor: {
+		GLuint index = in.get<GLuint>();
+		GLuint divisor = in.get<GLuint>();
+		TIMED(glVertexAttribDivisor(index,divisor));
+		break;
+	}
+	case GLCall_CreateShader: {
+		GLenum type = in.get<GLenum>();
+		GLuint traced = in.get<GLuint>();
+		GLuint shader = 0;
+		TIMED(shader = glCreateShader(type));
+		shaderObjects[traced] = shader;
+		break;
+	}
+	case GLCall_DeleteShader: { GLuint shader = lookup(shaderObjects, in.get<GLuint>()); TIMED(glDeleteShader(shader)); break; }
+	case GLCall_ShaderSource: {
+		GLuint shader = lookup(shaderObjects, in.get<GLuint>());
+		GLsizei count = in.get<GLsizei>();
+		std::vector<const GLchar*> strings(count);
+		std::vector<GLint> lengths(count);
+		for(GLsizei i=0;i<count;i++){
+			uint32_t size;
+			strings[i] = in.getBytes(size);
+			lengths[i] = size;
+		}
+		TIMED(glShaderSource(shader, count, strings.data(), lengths.data()));
+		break;
+	}
+	case GLCall_CompileShader: { GLuint shader = lookup(shaderObjects, in.get<GLuint>()); TIMED(glCompileShader(shader)); break; }
+	case GLCall_GetShaderiv: {
+		GLuint shader = lookup(shaderObjects, in.get<GLuint>());
+		GLenum pname = in.get<GLenum>();
+		GLint value;
+		TIMED(glGetShaderiv(shader,pname,&value));
+		break;
+	}
+	case GLCall_GetShaderInfoLog: {
+		GLuint shader = lookup(shaderObjects, in.get<GLuint>());
+		GLsizei bufSize = in.get<GLsizei>();
+		std::vector<GLchar> log(bufSize + 1);
+		TIMED(glGetShaderInfoLog(shader, bufSize, nullptr, log.data()));
+		break;
+	}
+	case GLCall_CreateProgram: {
+		GLuint traced = in.get<GLuint>();
+		GLuint program = 0;
+		TIMED(program = glCreateProgram());
+		shaderObjects[traced] = program;
+		break;
+	}
+	case GLCall_DeleteProgram: { GLuint program = lookup(shaderObjects, in.get<GLuint>()); TIMED(glDeleteProgram(program)); break; }
+	case GLCall_AttachShader: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		GLuint shader = lookup(shaderObjects, in.get<GLuint>());
+		TIMED(glAttachShader(program,shader));
+		break;
+	}
+	case GLCall_BindAttribLocation: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		GLuint index = in.get<GLuint>();
+		std::string name = in.getString();
+		TIMED(glBindAttribLocation(program, index, name.c_str()));
+		break;
+	}
+	case GLCall_LinkProgram: { GLuint program = lookup(shaderObjects, in.get<GLuint>()); TIMED(glLinkProgram(program)); break; }
+	case GLCall_GetProgramiv: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		GLenum pname = in.get<GLenum>();
+		GLint value;
+		TIMED(glGetProgramiv(program,pname,&value));
+		break;
+	}
+	case GLCall_GetProgramInfoLog: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		GLsizei bufSize = in.get<GLsizei>();
+		std::vector<GLchar> log(bufSize + 1);
+		TIMED(glGetProgramInfoLog(program, bufSize, nullptr, log.data()));
+		break;
+	}
+	case GLCall_UseProgram: {
+		GLuint traced = in.get<GLuint>();
+		GLuint program = lookup(shaderObjects, traced);
+		currentProgram = traced;
+		TIMED(glUseProgram(program));
+		break;
+	}
+	case GLCall_GetUniformLocation: {
+		GLuint traced = in.get<GLuint>();
+		GLuint program = lookup(shaderObjects, traced);
+		std::string name = in.getString();
+		GLint tracedLocation = in.get<GLint>();
+		GLint location = -1;
+		TIMED(location = glGetUniformLocation(program, name.c_str()));
+		uniformLocations[(uint64_t(traced) << 32) | uint32_t(tracedLocation)] = location;
+		break;
+	}
+	//block indices only depend on the program's source, so they replay as they were
+	case GLCall_GetUniformBlockIndex: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		std::string name = in.getString();
+		TIMED(glGetUniformBlockIndex(program, name.c_str()));
+		break;
+	}
+	case GLCall_UniformBlockBinding: {
+		GLuint program = lookup(shaderObjects, in.get<GLuint>());
+		GLuint block = in.get<GLuint>();
+		GLuint binding = in.get<GLuint>();
+		TIMED(glUniformBlockBinding(program,block,binding));
+		break;
+	}
+	default:
+		break;
+	}
+	//uniforms all start with a location in the current program
+	if(op >= GLCall_Uniform1i && op <= GLCall_UniformMatrix4fv){
+		GLint tracedLocation = in.get<GLint>();
+		auto found = uniformLocations.find((uint64_t(currentProgram) << 32) | uint32_t(tracedLocation));
+		GLint location = found == uniformLocations.end() ? tracedLocation : found->second;
+		switch(op){
+		case GLCall_Uniform1i: { GLint v0 = in.get<GLint>(); TIMED(glUniform1i(location,v0)); break; }
+		case GLCall_Uniform1f: { GLfloat v0 = in.get<GLfloat>(); TIMED(glUniform1f(location,v0)); break; }
+		case GLCall_Uniform3f: {
+			GLfloat v0 = in.get<GLfloat>(), v1 = in.get<GLfloat>(), v2 = in.get<GLfloat>();
+			TIMED(glUniform3f(location,v0,v1,v2));
+			break;
+		}
+		case GLCall_Uniform4f: {
+			GLfloat v0 = in.get<GLfloat>(), v1 = in.get<GLfloat>(), v2 = in.get<GLfloat>(), v3 = in.get<GLfloat>();
+			TIMED(glUniform4f(location,v0,v1,v2,v3));
+			break;
+		}
+		case GLCall_Uniform3fv: {
+			uint32_t size;
+			const GLfloat* value = (const GLfloat*)in.getBytes(size);
+			TIMED(glUniform3fv(location, size / (3 * sizeof(GLfloat)), value));
+			break;
+		}
+		case GLCall_Uniform4fv: {
+			uint32_t size;
+			const GLfloat* value = (const GLfloat*)in.getBytes(size);
+			TIMED(glUniform4fv(location, size / (4 * sizeof(GLfloat)), value));
+			break;
+		}
+		case GLCall_UniformMatrix4fv: {
+			GLboolean transpose = in.get<GLboolean>();
+			uint32_t size;
+			const GLfloat* value = (const GLfloat*)in.getBytes(size);
+			TIMED(glUniformMatrix4fv(location, size / (16 * sizeof(GLfloat)), transpose, value));
+			break;
+		}
+		}
+	}
+#undef TIMED
+	auto end = std::chrono::high_resolution_clock::now();
+	if(in.overrun || op >= GLCall_Count){
+		printf("GL trace is truncated or corrupt at byte %u\n", (unsigned int)position);
+		return false;
+	}
+	if(scanning){
+		return true;
+	}
+	timings.calls[op]++;
+	timings.nanoseconds[op] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	return true;
+}
+
+bool GLTraceReplay::playFrame(){
+	if(position >= lastFrameEnd){
+		return false;
+	}
+	uint64_t frameNanoseconds = 0;
+	while(position + sizeof(uint16_t) <= lastFrameEnd){
+		uint16_t op;
+		memcpy(&op, data->data() + position, sizeof(op));
+		position += sizeof(op);
+		if(op == GLTraceEndFrame){
+			break;
+		}
+		uint64_t before = op < GLCall_Count ? timings.nanoseconds[op] : 0;
+		if(!playCall(op)){
+			position = data->size();
+			return false;
+		}
+		frameNanoseconds += timings.nanoseconds[op] - before;
+	}
+	timings.frames.push_back(frameNanoseconds);
+	return true;
+}
+
+void GLTraceReplay::rewind(){
+	if(firstFrame > 0){
+		position = firstFrame;
+	}
+}
+
+void GLTraceReplay::playTeardown(){
+	position = lastFrameEnd;
+	while(position + sizeof(uint16_t) <= data->size()){
+		uint16_t op;
+		memcpy(&op, data->data() + position, sizeof(op));
+		position += sizeof(op);
+		if(!playCall(op)){
+			break;
+		}
+	}
+	position = data->size();
+}
+
+void GLTraceReplay::printTimings(){
+	printf("%-28s %10s %12s %10s\n", "call", "count", "total ms", "avg us");
+	for(int i=0;i<GLCall_Count;i++){
+		if(timings.calls[i] == 0){
+			continue;
+		}
+		double total = timings.nanoseconds[i] / 1e6;
+		double average = timings.nanoseconds[i] / 1e3 / timings.calls[i];
+		printf("%-28s %10u %12.3f %10.3f\n", glCallName(GLCall(i)), timings.calls[i], total, average);
+	}
+	//the first frame holds all of the setup, keep it out of the frame statistics
+	if(timings.frames.size() > 1){
+		uint64_t total = 0, shortest = UINT64_MAX, longest = 0;
+		for(size_t i=1;i<timings.frames.size();i++){
+			total += timings.frames[i];
+			shortest = std::min(shortest, timings.frames[i]);
+			longest = std::max(longest, timings.frames[i]);
+		}
+		printf("%u frames after setup: avg %.3f us, min %.3f us, max %.3f us of GL calls per frame\n",
+			(unsigned int)(timings.frames.size() - 1), total / 1e3 / (timings.frames.size() - 1), shortest / 1e3, longest / 1e3);
+	}
+	if(!timings.frames.empty()){
+		printf("setup frame: %.3f ms\n", timings.frames[0] / 1e6);
+	}
+}
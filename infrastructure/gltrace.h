@@ -0,0 +1,93 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "glrecorder.h"
+#include "fileview.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Binary trace of OpenGL calls
+//	The file starts with "GLTR" and a version number, followed by one record per call:
+//	a 16 bit GLCall opcode followed by the call's arguments packed as they are,
+//	pointer sized values widened to 64 bits and pointed to data inlined with a 32 bit length.
+//	Names handed out by the driver (buffers, shaders, uniform locations...) are recorded
+//	so the replay can map them onto whatever its own driver hands out.
+//	GLTraceEndFrame marks each glfwSwapBuffers.
+const uint16_t GLTraceEndFrame = GLCall_Count;
+
+//Starts writing every recorded OpenGL call to the given file, forwarding each call to the
+//	backend that was installed before (native or recording). Needs loadGL to have run.
+bool startGLTrace(std::string filename);
+void stopGLTrace();
+bool isTracingGL();
+//called once per frame by swapBuffers
+void markGLTraceFrame();
+
+struct GLTraceTimings {
+	unsigned int calls[GLCall_Count];
+	//CPU time spent inside each kind of call, in nanoseconds
+	uint64_t nanoseconds[GLCall_Count];
+	//CPU time of each replayed frame, in nanoseconds
+	std::vector<uint64_t> frames;
+};
+
+//Plays a trace back against the current context, timing each call
+class GLTraceReplay {
+private:
+	std::unique_ptr<FileView> data;
+	size_t position;
+	GLTraceTimings timings;
+	size_t firstFrame;
+	//just past the last frame marker, what follows is the demo's teardown
+	size_t lastFrameEnd;
+	//decodes calls without making them, to find the frame markers
+	bool scanning;
+	//traced names to the ones the replaying driver handed out
+	std::unordered_map<GLuint,GLuint> buffers;
+	std::unordered_map<GLuint,GLuint> vertexArrays;
+	std::unordered_map<GLuint,GLuint> shaderObjects;
+	//keyed by traced program and traced location
+	std::unordered_map<uint64_t,GLint> uniformLocations;
+	std::unordered_map<uint64_t,GLsync> syncs;
+	//this replay's own pointer of the current mapping on each target
+	std::unordered_map<GLenum,char*> mappedRanges;
+	GLuint currentProgram;
+	GLTraceReplay(std::unique_ptr<FileView> contents);
+	bool playCall(uint16_t op);
+	void findFrames();
+public:
+	//returns an empty pointer if the file can't be read or isn't a trace
+	static std::unique_ptr<GLTraceReplay> Create(std::string filename);
+	//plays every call up to the next frame marker, returns false after the last frame
+	bool playFrame();
+	//starts over from the second frame, the first one also holds all of the setup
+	void rewind();
+	//plays what the demo called after its last frame, deleting everything, so only once after the last loop
+	void playTeardown();
+	const GLTraceTimings& getTimings(){
+		return timings;
+	}
+	void printTimings();
+};
@@ -23,15 +23,22 @@ THE SOFTWARE.
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "infrastructure.h"
+#include "glloader.h"
+#include "gldebug.h"
+#include "glrecorder.h"
+#include "gltrace.h"
+#include "glstatecache.h"
+#include "shader.h"
+#include "filewatcher.h"
+#include "embeddedshaders.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
-#include <fstream>
 #include <iostream>
 
 #ifdef __EMSCRIPTEN__
 #include <SDL/SDL_opengl.h>
-#define glDebugMessageCallback glDebugMessageCallbackARB
-#define GLDEBUGPROC GLDEBUGPROCARB
 #endif
 
 void glfwErrorCallback(int error, const char* description){
@@ -92,7 +99,7 @@ void APIENTRY openglErrorCallback(GLenum source,
 	default:
 		break;
 	}
-	printf("%sid: %d: %s",text.c_str(),id,message);
+	printf("%sid: %d: %s\n",text.c_str(),id,message);
 	
 }
 
@@ -102,8 +109,24 @@ void onKeyPressed(GLFWwindow* window, int key, int scancode, int action, int mod
         glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
+static unsigned int frameCount = 0;
+static unsigned int frameLimit = 0;
+
 GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle){
+	GLBackend backend = GLBackend::Native;
+	const char* backendName = getenv("DEMO_GL_BACKEND");
+	if(backendName && std::string(backendName) == "recording"){
+		backend = GLBackend::Recording;
+	}
+	return init(windowWidth,windowHeight,windowTitle,backend);
+}
+
+GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle, GLBackend backend){
 	GLFWwindow* window;
+	const char* frameLimitString = getenv("DEMO_FRAME_LIMIT");
+	if(frameLimitString){
+		frameLimit = atoi(frameLimitString);
+	}
 	//set an error handling callback so we know if we have trouble initializing GLFW or OpenGL
 	glfwSetErrorCallback(glfwErrorCallback);
 	//intialize GLFW, which abstracts the OS specific method for intializing OpenGL and getting input
@@ -120,16 +143,12 @@ GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle){
 	}
 	//In order to call OpenGL you have to make the context current on your thread first
 	glfwMakeContextCurrent(window);
-	//Initialize GLEW, which provides access to OpenGL extensions
-	glewInit();
-	GLenum err = glewInit();
-	if (GLEW_OK != err)
-	{
-		printf("glewInit failed, aborting.\n");
+	//Load the OpenGL functions past 1.1 that the demos use, see glloader.h
+	if(!loadGL()){
+		printf("Loading OpenGL failed, aborting.\n");
 		glfwTerminate();
 		return nullptr;
 	}
-	printf("Status: Using GLEW %s\n",glewGetString(GLEW_VERSION));
 #ifndef __EMSCRIPTEN__
 	//enable VSYNC so we don't get ugly tearing
 	glfwSwapInterval(1);
@@ -140,36 +159,68 @@ GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle){
 	printf("GL_RENDERER   = %s\n", (char *) glGetString(GL_RENDERER));
 	printf("GL_VERSION    = %s\n", (char *) glGetString(GL_VERSION));
 	printf("GL_VENDOR     = %s\n", (char *) glGetString(GL_VENDOR));
-	//get the available OpenGL extensions
-	char* extensionsptr = (char *) glGetString(GL_EXTENSIONS);
-	if(extensionsptr){
-            std::string gl_extensions = extensionsptr;
-            //The GL_KHR_debug extension makes handling OpenGL errors much easier
-            //	If glDebugMessageCallback is 0x0 it means GLEW couldn't load the function, so we can't use it
-            if(glDebugMessageCallback != 0x0 && gl_extensions.find("GL_KHR_debug") != std::string::npos){
-                glDebugMessageCallback((GLDEBUGPROC)openglErrorCallback,nullptr);
-                glEnable(GL_DEBUG_OUTPUT);
-                glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-            } else if(glDebugMessageCallbackARB != 0x0 && gl_extensions.find("GL_ARB_debug_output") != std::string::npos){
-                glDebugMessageCallbackARB((GLDEBUGPROC)openglErrorCallback,nullptr);
-                glEnable(GL_DEBUG_OUTPUT);
-                glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-            } else {
-                printf("Warning: this OpenGL context doesn't support debug extensions!\n");
-            }
-        } else {
-            printf("Warning: this OpenGL context doesn't support debug extensions!\n");
-        }
+	//The GL_KHR_debug extension makes handling OpenGL errors much easier
+	//	DEMO_GL_DEBUG=sync prints each message from inside the call that caused it, see gldebug.h
+	if(!startGLDebugOutput(glDebugModeFromEnvironment())){
+		printf("Warning: this OpenGL context doesn't support debug extensions!\n");
+	}
+#ifndef __EMSCRIPTEN__
+	if(glMaxShaderCompilerThreadsKHR){
+		//as many compiler threads as the driver likes
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+#endif
+	if(backend == GLBackend::Recording){
+		//the context stays around but nothing reaches it from here on, so don't wait on VSYNC either
+		installRecordingGL();
+		glfwSwapInterval(0);
+		printf("Recording OpenGL calls instead of drawing\n");
+	}
+	//DEMO_GL_TRACE=file writes every call to file for gltrace_replay
+	const char* traceFilename = getenv("DEMO_GL_TRACE");
+	if(traceFilename && startGLTrace(traceFilename)){
+		printf("Tracing OpenGL calls to %s\n", traceFilename);
+	}
+	//installed last so that only the calls that actually change something get recorded or traced
+	//	DEMO_GL_STATE_CACHE=0 turns it off to compare against
+	const char* stateCache = getenv("DEMO_GL_STATE_CACHE");
+	if(!stateCache || std::string(stateCache) != "0"){
+		installGLStateCache();
+	}
 	return window;
 }
 
-std::string readContentsOfFile(std::string filename){
-	std::ifstream file(filename);
-	if(!file.is_open()){
-		return std::string();
+void swapBuffers(GLFWwindow* window){
+	glfwSwapBuffers(window);
+	frameCount++;
+	if(isTracingGL()){
+		markGLTraceFrame();
+	}
+	if(isRecordingGL()){
+		endGLFrame();
+	}
+	if(isCachingGLState()){
+		endGLStateCacheFrame();
 	}
-	std::istreambuf_iterator<char> eos;
-	std::string s(std::istreambuf_iterator<char>(file), eos);
+	endUniformUploadFrame();
+	//for Shader::reload
+	pollFileChanges();
+	if(isRecordingGL() && frameCount % 300 == 1){
+		printGLFrameStats();
+		if(isCachingGLState()){
+			printGLStateCacheStats();
+		}
+		printf("%u unchanged uniform uploads skipped\n", lastSkippedUniformUploads());
+	}
+	if(frameLimit > 0 && frameCount >= frameLimit){
+		glfwSetWindowShouldClose(window, GL_TRUE);
+	}
+}
+
+std::string readContentsOfFile(std::string filename){
+	//shaders may be compiled into the program
+	std::string s;
+	readShaderFile(filename, s);
 	return s;
 }
 
@@ -178,7 +229,8 @@ bool checkCompile(GLuint id){
 	glGetShaderiv(id, GL_COMPILE_STATUS, &compiled);
 	GLsizei length;
 	glGetShaderiv(id,GL_INFO_LOG_LENGTH,&length);
-	GLchar* buff = new GLchar[length];
+	GLchar* buff = new GLchar[length + 1];
+	buff[0] = '\0';
 	glGetShaderInfoLog(id,length,&length,buff);
 	//do something with error log
 	if (strlen(buff) > 0){
@@ -197,7 +249,8 @@ bool checkLink(GLuint id){
 	glGetProgramiv(id,GL_LINK_STATUS, &linked);
 	GLsizei length;
 	glGetProgramiv(id,GL_INFO_LOG_LENGTH,&length);
-	GLchar* buff = new GLchar[length];
+	GLchar* buff = new GLchar[length + 1];
+	buff[0] = '\0';
 	glGetProgramInfoLog(id,length,&length,buff);
 	//do something with error log
 	if (strlen(buff) > 0){
@@ -219,6 +272,6 @@ void waitForExit(GLFWwindow* window){
 	while(!glfwWindowShouldClose(window)){
 		glfwPollEvents();
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-		glfwSwapBuffers(window);
+		swapBuffers(window);
 	}
 }
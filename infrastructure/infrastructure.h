@@ -21,6 +21,13 @@ THE SOFTWARE.
 ***************************************************************************/
 #pragma once
 #include <string>
+#include "gldispatch.h"
+
+//Where the OpenGL calls made by the demos end up
+enum class GLBackend {
+	Native, //the driver of the context GLFW created
+	Recording //no-ops that only count calls, see glrecorder.h
+};
 
 void glfwErrorCallback(int error, const char* description);
 void APIENTRY openglErrorCallback(GLenum source,
@@ -31,7 +38,12 @@ void APIENTRY openglErrorCallback(GLenum source,
 						 const GLchar* message,
 						 const void* userParam);
 void onKeyPressed(GLFWwindow* window, int key, int scancode, int action, int modifiers);
+//picks the backend from the DEMO_GL_BACKEND environment variable ("native" or "recording")
 GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle);
+GLFWwindow* init(int windowWidth, int windowHeight, const char* windowTitle, GLBackend backend);
+//shows the finished frame and closes out the per-frame bookkeeping
+//	setting DEMO_FRAME_LIMIT in the environment closes the window after that many frames
+void swapBuffers(GLFWwindow* window);
 std::string readContentsOfFile(std::string filename);
 bool checkCompile(GLuint id);
 bool checkLink(GLuint id);
@@ -0,0 +1,291 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "mesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+struct FormatInfo {
+	GLint components;
+	GLenum type;
+	GLboolean normalized;
+	GLsizei size;
+};
+
+FormatInfo formatInfo(VertexFormat format){
+	switch(format){
+	case VertexFormat::Float1: return FormatInfo{1, GL_FLOAT, GL_FALSE, 4};
+	case VertexFormat::Float2: return FormatInfo{2, GL_FLOAT, GL_FALSE, 8};
+	case VertexFormat::Float3: return FormatInfo{3, GL_FLOAT, GL_FALSE, 12};
+	case VertexFormat::Float4: return FormatInfo{4, GL_FLOAT, GL_FALSE, 16};
+	case VertexFormat::SNorm8x4: return FormatInfo{4, GL_BYTE, GL_TRUE, 4};
+	default: return FormatInfo{2, GL_UNSIGNED_SHORT, GL_TRUE, 4};
+	}
+}
+
+//component c of a vertex, what GL fills in for the ones the mesh doesn't have
+float component(const float* values, int components, int c){
+	return c < components ? values[c] : c == 3 ? 1.f : 0.f;
+}
+
+void writeVertex(char* out, VertexFormat format, const float* values, int components){
+	switch(format){
+	case VertexFormat::SNorm8x4:
+		for(int c=0;c<4;c++){
+			//the fourth component stays 0, normals and tangents are directions
+			float value = c < 3 ? component(values, components, c) : 0.f;
+			((GLbyte*)out)[c] = GLbyte(std::round(std::min(std::max(value, -1.f), 1.f) * 127.f));
+		}
+		break;
+	case VertexFormat::UNorm16x2:
+		for(int c=0;c<2;c++){
+			float value = component(values, components, c);
+			((GLushort*)out)[c] = GLushort(std::round(std::min(std::max(value, 0.f), 1.f) * 65535.f));
+		}
+		break;
+	default:
+		for(int c=0;c<formatInfo(format).components;c++){
+			float value = component(values, components, c);
+			memcpy(out + c * sizeof(float), &value, sizeof(float));
+		}
+		break;
+	}
+}
+}
+
+VertexLayout& VertexLayout::add(GLuint location, VertexFormat format, unsigned int stream){
+	if(stream >= strides.size()){
+		strides.resize(stream + 1, 0);
+	}
+	attributes.push_back(VertexAttribute{location, format, stream, strides[stream]});
+	strides[stream] += formatInfo(format).size;
+	return *this;
+}
+
+VertexLayout VertexLayout::Interleaved(){
+	VertexLayout layout;
+	layout.add(PositionAttribute, VertexFormat::Float3);
+	layout.add(NormalAttribute, VertexFormat::Float3);
+	layout.add(TexCoordAttribute, VertexFormat::Float2);
+	return layout;
+}
+
+bool Mesh::setAttribute(GLuint location, int components, std::vector<float> values){
+	if(components <= 0 || values.size() % components != 0){
+		printf("Mesh attribute %u doesn't hold a whole number of %d component vertices\n", location, components);
+		return false;
+	}
+	size_t count = values.size() / components;
+	bool replacing = attributes.size() == 1 && attributes[0].location == location;
+	if(!attributes.empty() && !replacing && count != vertexCount){
+		printf("Mesh attribute %u has %zu vertices instead of %zu\n", location, count, vertexCount);
+		return false;
+	}
+	vertexCount = count;
+	for(Attribute& attribute : attributes){
+		if(attribute.location == location){
+			attribute.components = components;
+			attribute.values = std::move(values);
+			return true;
+		}
+	}
+	attributes.push_back(Attribute{location, components, std::move(values)});
+	return true;
+}
+
+const std::vector<float>* Mesh::getAttribute(GLuint location, int* components) const {
+	for(const Attribute& attribute : attributes){
+		if(attribute.location == location){
+			if(components){
+				*components = attribute.components;
+			}
+			return &attribute.values;
+		}
+	}
+	return nullptr;
+}
+
+bool Mesh::setIndices(std::vector<GLuint> meshIndices){
+	//attributes set later are checked when the mesh is uploaded
+	size_t outOfRange = findIndexOutOfRange(meshIndices.data(), meshIndices.size(), vertexCount);
+	if(!attributes.empty() && outOfRange < meshIndices.size()){
+		printf("Mesh index %zu is %u, past its %zu vertices\n", outOfRange, meshIndices[outOfRange], vertexCount);
+		return false;
+	}
+	indices = std::move(meshIndices);
+	return true;
+}
+
+bool Mesh::optimizeVertexCache(VertexCacheStats* before, VertexCacheStats* after){
+	if(primitive != GL_TRIANGLES || indices.empty() || findIndexOutOfRange(indices.data(), indices.size(), vertexCount) < indices.size()){
+		return false;
+	}
+	if(before){
+		*before = measureVertexCache(indices.data(), indices.size(), vertexCount);
+	}
+	::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+	if(after){
+		*after = measureVertexCache(indices.data(), indices.size(), vertexCount);
+	}
+	return true;
+}
+
+MeshBuffers::MeshBuffers() : vao(0), indexBuffer(0), primitive(GL_TRIANGLES), count(0), indexType(0), cacheOptimized(false), cacheBefore(), cacheAfter() {
+	glGenVertexArrays(1,&vao);
+}
+
+std::unique_ptr<MeshBuffers> MeshBuffers::Create(const Mesh& mesh, const VertexLayout& layout, GLenum usage){
+	for(const VertexAttribute& attribute : layout.getAttributes()){
+		if(!mesh.getAttribute(attribute.location)){
+			printf("The mesh has no attribute %u for its vertex layout\n", attribute.location);
+			return std::unique_ptr<MeshBuffers>();
+		}
+	}
+	const std::vector<GLuint>& meshIndices = mesh.getIndices();
+	size_t outOfRange = findIndexOutOfRange(meshIndices.data(), meshIndices.size(), mesh.getVertexCount());
+	if(outOfRange < meshIndices.size()){
+		printf("Mesh index %zu is %u, past its %zu vertices\n", outOfRange, meshIndices[outOfRange], mesh.getVertexCount());
+		return std::unique_ptr<MeshBuffers>();
+	}
+	std::unique_ptr<MeshBuffers> buffers(new MeshBuffers());
+	buffers->primitive = mesh.getPrimitiveType();
+	buffers->count = GLsizei(mesh.getElementCount());
+	size_t vertexCount = mesh.getVertexCount();
+	glBindVertexArray(buffers->vao);
+	buffers->vertexBuffers.resize(layout.getStreamCount());
+	glGenBuffers(GLsizei(buffers->vertexBuffers.size()), buffers->vertexBuffers.data());
+	std::vector<char> data;
+	for(unsigned int stream=0;stream<layout.getStreamCount();stream++){
+		GLsizei stride = layout.getStride(stream);
+		data.assign(vertexCount * stride, 0);
+		glBindBuffer(GL_ARRAY_BUFFER,buffers->vertexBuffers[stream]);
+		for(const VertexAttribute& attribute : layout.getAttributes()){
+			if(attribute.stream != stream){
+				continue;
+			}
+			int components = 0;
+			const float* values = mesh.getAttribute(attribute.location, &components)->data();
+			for(size_t v=0;v<vertexCount;v++){
+				writeVertex(data.data() + v * stride + attribute.offset, attribute.format, values + v * components, components);
+			}
+			FormatInfo info = formatInfo(attribute.format);
+			glEnableVertexAttribArray(attribute.location);
+			glVertexAttribPointer(attribute.location,info.components,info.type,info.normalized,stride,(GLvoid*)(size_t)attribute.offset);
+		}
+		glBufferData(GL_ARRAY_BUFFER,data.size(),data.data(),usage);
+	}
+	std::vector<GLuint> indices = meshIndices;
+	if(buffers->primitive == GL_TRIANGLES && !indices.empty()){
+		buffers->cacheBefore = measureVertexCache(indices.data(), indices.size(), vertexCount);
+		::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		buffers->cacheAfter = measureVertexCache(indices.data(), indices.size(), vertexCount);
+		buffers->cacheOptimized = true;
+	}
+	if(!indices.empty()){
+		glGenBuffers(1,&buffers->indexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,buffers->indexBuffer);
+		//the smallest type that can index every vertex
+		if(vertexCount <= 256){
+			std::vector<GLubyte> narrow(indices.begin(), indices.end());
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER,narrow.size(),narrow.data(),usage);
+			buffers->indexType = GL_UNSIGNED_BYTE;
+		} else if(vertexCount <= 65536){
+			std::vector<GLushort> narrow(indices.begin(), indices.end());
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER,narrow.size()*sizeof(GLushort),narrow.data(),usage);
+			buffers->indexType = GL_UNSIGNED_SHORT;
+		} else {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER,indices.size()*sizeof(GLuint),indices.data(),usage);
+			buffers->indexType = GL_UNSIGNED_INT;
+		}
+	}
+	glBindVertexArray(0);
+	return buffers;
+}
+
+MeshBuffers::~MeshBuffers(){
+	if(indexBuffer){
+		glDeleteBuffers(1,&indexBuffer);
+	}
+	glDeleteBuffers(GLsizei(vertexBuffers.size()),vertexBuffers.data());
+	glDeleteVertexArrays(1,&vao);
+}
+
+bool MeshBuffers::getVertexCacheStats(VertexCacheStats* before, VertexCacheStats* after) const {
+	if(!cacheOptimized){
+		return false;
+	}
+	if(before){
+		*before = cacheBefore;
+	}
+	if(after){
+		*after = cacheAfter;
+	}
+	return true;
+}
+
+void MeshBuffers::draw(){
+	glBindVertexArray(vao);
+	if(indexType){
+		glDrawElements(primitive,count,indexType,0);
+	} else {
+		glDrawArrays(primitive,0,count);
+	}
+}
+
+void setShapeAttributes(Mesh& mesh, const std::vector<float>& vertexData, int stride, int positionSize, int position, int normal, int texCoord){
+	size_t vertexCount = vertexData.size() / stride;
+	std::vector<float> positions(vertexCount * 3), normals(vertexCount * 3), texCoords(vertexCount * 2);
+	for(size_t v=0;v<vertexCount;v++){
+		const float* vertex = vertexData.data() + v*stride;
+		for(int c=0;c<3;c++){
+			positions[v*3+c] = c < positionSize ? vertex[position+c] : 0.f;
+			//flat shapes without normals face +z
+			normals[v*3+c] = normal < 0 ? (c == 2 ? 1.f : 0.f) : vertex[normal+c];
+		}
+		for(int c=0;c<2;c++){
+			texCoords[v*2+c] = texCoord < 0 ? 0.f : vertex[texCoord+c];
+		}
+	}
+	mesh.setAttribute(PositionAttribute, 3, std::move(positions));
+	mesh.setAttribute(NormalAttribute, 3, std::move(normals));
+	mesh.setAttribute(TexCoordAttribute, 2, std::move(texCoords));
+}
+
+std::vector<GLuint> widenIndices(const void* indices, size_t count, GLenum type){
+	std::vector<GLuint> wide(count);
+	for(size_t i=0;i<count;i++){
+		switch(type){
+		case GL_UNSIGNED_BYTE:
+			wide[i] = ((const GLubyte*)indices)[i];
+			break;
+		case GL_UNSIGNED_SHORT:
+			wide[i] = ((const GLushort*)indices)[i];
+			break;
+		default:
+			wide[i] = ((const GLuint*)indices)[i];
+			break;
+		}
+	}
+	return wide;
+}
@@ -0,0 +1,210 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include "geometry.h"
+#include "vertexcache.h"
+#include <memory>
+#include <vector>
+
+//Attribute locations the demo shaders use (see MeshVertex in meshregistry.h)
+const GLuint PositionAttribute = 0;
+const GLuint NormalAttribute = 1;
+const GLuint TexCoordAttribute = 2;
+
+//How an attribute is stored in a vertex buffer, Mesh keeps every attribute as floats and converts on upload
+enum class VertexFormat {
+	Float1,
+	Float2,
+	Float3,
+	Float4,
+	//-1 to 1 in bytes, for normals and tangents (the fourth component is 0)
+	SNorm8x4,
+	//0 to 1 in unsigned shorts, for texture coordinates
+	UNorm16x2
+};
+
+//One attribute of a VertexLayout, offset is filled in by VertexLayout::add
+struct VertexAttribute {
+	GLuint location;
+	VertexFormat format;
+	unsigned int stream;
+	GLsizei offset;
+};
+
+//Which attributes a MeshBuffers has and how they are laid out
+//	Each stream is one vertex buffer; the attributes in a stream are interleaved in the order they were added,
+//	so one stream holding everything is fully interleaved and one stream per attribute is fully split.
+//	A depth only pass can use just the position in a stream of its own, for instance.
+class VertexLayout {
+private:
+	std::vector<VertexAttribute> attributes;
+	std::vector<GLsizei> strides;
+public:
+	VertexLayout& add(GLuint location, VertexFormat format, unsigned int stream = 0);
+	const std::vector<VertexAttribute>& getAttributes() const {
+		return attributes;
+	}
+	size_t getStreamCount() const {
+		return strides.size();
+	}
+	GLsizei getStride(unsigned int stream) const {
+		return strides[stream];
+	}
+	//position, normal and texture coordinate as floats in one stream, what the demo shaders expect
+	static VertexLayout Interleaved();
+};
+
+//Vertices and indices built at runtime, kept on the CPU until uploaded into a MeshBuffers
+//	Each attribute is its own array of floats, indexed by attribute location.
+class Mesh {
+private:
+	struct Attribute {
+		GLuint location;
+		int components;
+		std::vector<float> values;
+	};
+	GLenum primitive;
+	size_t vertexCount;
+	std::vector<Attribute> attributes;
+	std::vector<GLuint> indices;
+public:
+	Mesh(GLenum primitive = GL_TRIANGLES) : primitive(primitive), vertexCount(0) {}
+	//every attribute needs the same number of vertices, the first one set decides it
+	bool setAttribute(GLuint location, int components, std::vector<float> values);
+	//null if the mesh doesn't have the attribute
+	const std::vector<float>* getAttribute(GLuint location, int* components = nullptr) const;
+	//no indices draws the vertices in order
+	//	False, keeping the indices it had, if one is past the vertices the attributes already set have.
+	bool setIndices(std::vector<GLuint> meshIndices);
+	const std::vector<GLuint>& getIndices() const {
+		return indices;
+	}
+	GLenum getPrimitiveType() const {
+		return primitive;
+	}
+	size_t getVertexCount() const {
+		return vertexCount;
+	}
+	//reorders an indexed triangle list's triangles for the vertex cache (see vertexcache.h)
+	//	MeshBuffers::Create and MeshRegistry::add do this to what they upload, this changes the Mesh itself.
+	//	before and after, if given, get how well the cache was used; false if there are no indexed triangles to reorder
+	bool optimizeVertexCache(VertexCacheStats* before = nullptr, VertexCacheStats* after = nullptr);
+	//the number of vertices a draw reads, indices if it has them
+	size_t getElementCount() const {
+		return indices.empty() ? vertexCount : indices.size();
+	}
+	//runs one of the shapes in geometry.h (see MeshSource)
+	template<class T>
+	static Mesh FromShape();
+};
+
+//A Mesh uploaded in a given VertexLayout, with its own vertex array and one buffer per stream
+//	The same Mesh can be uploaded in several layouts, one per pass.
+class MeshBuffers {
+private:
+	GLuint vao;
+	std::vector<GLuint> vertexBuffers;
+	GLuint indexBuffer;
+	GLenum primitive;
+	GLsizei count;
+	GLenum indexType;
+	bool cacheOptimized;
+	VertexCacheStats cacheBefore;
+	VertexCacheStats cacheAfter;
+	MeshBuffers();
+public:
+	//empty if the layout has an attribute the mesh doesn't or an index is past its vertices
+	//	Indexed triangle lists go up in vertex cache order (see optimizeVertexCache), the Mesh itself is left as it is.
+	static std::unique_ptr<MeshBuffers> Create(const Mesh& mesh, const VertexLayout& layout, GLenum usage = GL_STATIC_DRAW);
+	~MeshBuffers();
+	MeshBuffers(const MeshBuffers&) = delete;
+	MeshBuffers& operator=(const MeshBuffers&) = delete;
+	void draw();
+	DrawCall getDrawCall(){
+		return DrawCall{vao, primitive, count, indexType};
+	}
+	GLuint getVertexArray(){
+		return vao;
+	}
+	//how the index order Create was given and the one it uploaded use the vertex cache, false if it wasn't reordered
+	bool getVertexCacheStats(VertexCacheStats* before, VertexCacheStats* after) const;
+};
+
+//Where a shape's vertexData() has each attribute, in floats, so it can be turned into a Mesh
+//	A negative offset means the shape doesn't have that attribute.
+//	New shapes need a specialization here to become a Mesh.
+template<class T>
+struct MeshSource;
+template<>
+struct MeshSource<Billboard> {
+	static const bool indexed = false;
+	static const int stride = 4, positionSize = 2, position = 0, normal = -1, texCoord = 2;
+};
+template<>
+struct MeshSource<Plane> {
+	static const bool indexed = false;
+	static const int stride = 8, positionSize = 3, position = 0, normal = 3, texCoord = 6;
+};
+template<>
+struct MeshSource<SharpCube> {
+	static const bool indexed = true;
+	static const int stride = 8, positionSize = 3, position = 0, normal = 5, texCoord = 3;
+};
+template<int N>
+struct MeshSource<Grid<N>> {
+	static const bool indexed = true;
+	static const int stride = 8, positionSize = 3, position = 0, normal = 3, texCoord = 6;
+};
+template<int N>
+struct MeshSource<SubdividedCube<N>> {
+	static const bool indexed = true;
+	static const int stride = 8, positionSize = 3, position = 0, normal = 3, texCoord = 6;
+};
+
+//splits interleaved shape vertices into the mesh's attributes
+void setShapeAttributes(Mesh& mesh, const std::vector<float>& vertexData, int stride, int positionSize, int position, int normal, int texCoord);
+//widens a shape's byte, short or int indices
+std::vector<GLuint> widenIndices(const void* indices, size_t count, GLenum type);
+
+template<class T, bool indexed = MeshSource<T>::indexed>
+struct MeshTesselator {
+	static void tesselate(Mesh& mesh){
+		mesh.setIndices(widenIndices(T::indexData(), T::getElementCount(), T::getIndexType()));
+	}
+};
+template<class T>
+struct MeshTesselator<T,false> {
+	static void tesselate(Mesh&){
+	}
+};
+
+template<class T>
+Mesh Mesh::FromShape(){
+	typedef MeshSource<T> Source;
+	Mesh mesh(T::getPrimitiveType());
+	std::vector<float> vertexData(T::vertexData(), T::vertexData() + T::vertexBufferSize() / sizeof(float));
+	MeshTesselator<T>::tesselate(mesh);
+	setShapeAttributes(mesh, vertexData, Source::stride, Source::positionSize, Source::position, Source::normal, Source::texCoord);
+	return mesh;
+}
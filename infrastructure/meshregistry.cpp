@@ -0,0 +1,206 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "meshregistry.h"
+#include "glloader.h"
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+
+MeshRegistry::MeshRegistry() : uploaded(false), cacheTriangles(0.f), cacheVerticesUsed(0.f), cacheMissesBefore(0.f), cacheMissesAfter(0.f) {
+	glGenVertexArrays(1,&vao);
+	glGenBuffers(1,&vbo);
+	glGenBuffers(1,&ibo);
+}
+
+std::unique_ptr<MeshRegistry> MeshRegistry::Create(){
+	return std::unique_ptr<MeshRegistry>(new MeshRegistry());
+}
+
+MeshRegistry::~MeshRegistry(){
+	glDeleteBuffers(1,&ibo);
+	glDeleteBuffers(1,&vbo);
+	glDeleteVertexArrays(1,&vao);
+}
+
+static GLuint indexAt(const void* indices, size_t i, GLenum type){
+	if(!indices){
+		return GLuint(i);
+	}
+	switch(type){
+	case GL_UNSIGNED_BYTE:
+		return ((const GLubyte*)indices)[i];
+	case GL_UNSIGNED_SHORT:
+		return ((const GLushort*)indices)[i];
+	default:
+		return ((const GLuint*)indices)[i];
+	}
+}
+
+void MeshRegistry::appendIndices(const void* indices, size_t count, GLenum type, GLenum primitive, std::vector<GLuint>& triangles){
+	if(primitive == GL_TRIANGLE_STRIP){
+		//alternate the winding of every other triangle so they all face the same way
+		for(size_t i=0;i+2<count;i++){
+			bool even = i % 2 == 0;
+			triangles.push_back(indexAt(indices, even ? i : i+1, type));
+			triangles.push_back(indexAt(indices, even ? i+1 : i, type));
+			triangles.push_back(indexAt(indices, i+2, type));
+		}
+	} else {
+		for(size_t i=0;i<count;i++){
+			triangles.push_back(indexAt(indices, i, type));
+		}
+	}
+}
+
+MeshHandle MeshRegistry::add(const std::vector<MeshVertex>& meshVertices, const std::vector<GLuint>& meshIndices){
+	if(uploaded){
+		printf("Warning: adding a mesh to a MeshRegistry after upload(), call upload() again\n");
+	}
+	MeshHandle handle = {};
+	size_t outOfRange = findIndexOutOfRange(meshIndices.data(), meshIndices.size(), meshVertices.size());
+	if(outOfRange < meshIndices.size()){
+		printf("Mesh index %zu is %u, past its %zu vertices, it isn't added to the MeshRegistry\n", outOfRange, meshIndices[outOfRange], meshVertices.size());
+		return handle;
+	}
+	handle.firstIndex = GLuint(indices.size());
+	handle.indexCount = GLuint(meshIndices.size());
+	handle.baseVertex = GLint(vertices.size());
+	vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+	indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+	GLuint* added = indices.data() + handle.firstIndex;
+	VertexCacheStats before = measureVertexCache(added, meshIndices.size(), meshVertices.size());
+	optimizeVertexCache(added, meshIndices.size(), meshVertices.size());
+	VertexCacheStats after = measureVertexCache(added, meshIndices.size(), meshVertices.size());
+	//the stats are ratios, so they're added up as the misses and vertices they came from
+	float triangles = float(meshIndices.size() / 3);
+	cacheTriangles += triangles;
+	cacheMissesBefore += before.acmr * triangles;
+	cacheMissesAfter += after.acmr * triangles;
+	cacheVerticesUsed += before.atvr > 0.f ? before.acmr * triangles / before.atvr : 0.f;
+	return handle;
+}
+
+void MeshRegistry::getVertexCacheStats(VertexCacheStats* before, VertexCacheStats* after) const {
+	if(before){
+		before->acmr = cacheTriangles > 0.f ? cacheMissesBefore / cacheTriangles : 0.f;
+		before->atvr = cacheVerticesUsed > 0.f ? cacheMissesBefore / cacheVerticesUsed : 0.f;
+	}
+	if(after){
+		after->acmr = cacheTriangles > 0.f ? cacheMissesAfter / cacheTriangles : 0.f;
+		after->atvr = cacheVerticesUsed > 0.f ? cacheMissesAfter / cacheVerticesUsed : 0.f;
+	}
+}
+
+MeshHandle MeshRegistry::add(const Mesh& mesh){
+	int positionSize = 0, normalSize = 0, texCoordSize = 0;
+	const std::vector<float>* positions = mesh.getAttribute(PositionAttribute, &positionSize);
+	const std::vector<float>* normals = mesh.getAttribute(NormalAttribute, &normalSize);
+	const std::vector<float>* texCoords = mesh.getAttribute(TexCoordAttribute, &texCoordSize);
+	std::vector<MeshVertex> meshVertices(mesh.getVertexCount());
+	for(size_t v=0;v<meshVertices.size();v++){
+		MeshVertex& vertex = meshVertices[v];
+		for(int c=0;c<3;c++){
+			vertex.position[c] = positions && c < positionSize ? (*positions)[v*positionSize+c] : 0.f;
+			vertex.normal[c] = normals && c < normalSize ? (*normals)[v*normalSize+c] : (c == 2 ? 1.f : 0.f);
+		}
+		for(int c=0;c<2;c++){
+			vertex.texCoord[c] = texCoords && c < texCoordSize ? (*texCoords)[v*texCoordSize+c] : 0.f;
+		}
+	}
+	std::vector<GLuint> meshIndices;
+	const std::vector<GLuint>& indices = mesh.getIndices();
+	appendIndices(indices.empty() ? nullptr : indices.data(), mesh.getElementCount(), GL_UNSIGNED_INT, mesh.getPrimitiveType(), meshIndices);
+	return add(meshVertices, meshIndices);
+}
+
+void MeshRegistry::upload(){
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER,vbo);
+	glBufferData(GL_ARRAY_BUFFER,vertices.size()*sizeof(MeshVertex),vertices.data(),GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER,indices.size()*sizeof(GLuint),indices.data(),GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(MeshVertex),(GLvoid*)offsetof(MeshVertex,position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(MeshVertex),(GLvoid*)offsetof(MeshVertex,normal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,sizeof(MeshVertex),(GLvoid*)offsetof(MeshVertex,texCoord));
+	glBindVertexArray(0);
+	uploaded = true;
+}
+
+MultiDrawBatch::MultiDrawBatch() : capacity(0) {
+	glGenBuffers(1,&commandBuffer);
+	glGenBuffers(1,&drawDataBuffer);
+}
+
+std::unique_ptr<MultiDrawBatch> MultiDrawBatch::Create(){
+	if(!(hasGLVersion(4,3) || hasGLExtension("GL_ARB_multi_draw_indirect")) || !(hasGLVersion(4,3) || hasGLExtension("GL_ARB_shader_storage_buffer_object"))){
+		printf("MultiDrawBatch needs multi draw indirect and shader storage buffers\n");
+		return std::unique_ptr<MultiDrawBatch>();
+	}
+	if(!hasGLExtension("GL_ARB_shader_draw_parameters")){
+		printf("MultiDrawBatch needs GL_ARB_shader_draw_parameters for gl_DrawIDARB\n");
+		return std::unique_ptr<MultiDrawBatch>();
+	}
+	return std::unique_ptr<MultiDrawBatch>(new MultiDrawBatch());
+}
+
+MultiDrawBatch::~MultiDrawBatch(){
+	glDeleteBuffers(1,&drawDataBuffer);
+	glDeleteBuffers(1,&commandBuffer);
+}
+
+void MultiDrawBatch::add(const MeshHandle& mesh, const InstanceData& data){
+	commands.push_back(DrawElementsIndirectCommand{mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, 0});
+	drawData.push_back(data);
+}
+
+void MultiDrawBatch::resize(size_t count){
+	commands.resize(count);
+	drawData.resize(count);
+}
+
+void MultiDrawBatch::clear(){
+	commands.clear();
+	drawData.clear();
+}
+
+void MultiDrawBatch::draw(MeshRegistry& registry, GLuint drawDataBinding){
+	if(commands.empty()){
+		return;
+	}
+	glBindVertexArray(registry.getVertexArray());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER,commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER,drawDataBuffer);
+	//grow to fit, otherwise overwrite in place
+	if(commands.size() > capacity){
+		capacity = commands.size();
+		glBufferData(GL_DRAW_INDIRECT_BUFFER,capacity*sizeof(DrawElementsIndirectCommand),commands.data(),GL_DYNAMIC_DRAW);
+		glBufferData(GL_SHADER_STORAGE_BUFFER,capacity*sizeof(InstanceData),drawData.data(),GL_DYNAMIC_DRAW);
+	} else {
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER,0,commands.size()*sizeof(DrawElementsIndirectCommand),commands.data());
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER,0,drawData.size()*sizeof(InstanceData),drawData.data());
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER,drawDataBinding,drawDataBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES,GL_UNSIGNED_INT,0,GLsizei(commands.size()),0);
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include "geometry.h"
+#include "mesh.h"
+#include "glm/glm.hpp"
+#include <memory>
+#include <vector>
+
+//The one vertex format every mesh in a MeshRegistry is converted to
+//	position, normal and texture coordinate at attributes 0, 1 and 2, like the demo shaders expect
+struct MeshVertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+};
+
+//A mesh's place in the registry's shared buffers
+struct MeshHandle {
+	GLuint firstIndex;
+	GLuint indexCount;
+	GLint baseVertex;
+};
+
+//Layout glMultiDrawElementsIndirect reads its commands in
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+//Packs any number of meshes into one vertex and one index buffer behind a single vertex array
+//	Every mesh is turned into an indexed triangle list, so they can all be drawn by one glMultiDrawElementsIndirect.
+class MeshRegistry {
+private:
+	GLuint vao;
+	GLuint vbo;
+	GLuint ibo;
+	std::vector<MeshVertex> vertices;
+	std::vector<GLuint> indices;
+	bool uploaded;
+	//totals over every mesh added, for getVertexCacheStats
+	float cacheTriangles;
+	float cacheVerticesUsed;
+	float cacheMissesBefore;
+	float cacheMissesAfter;
+	MeshRegistry();
+public:
+	//appends count indices (or 0..count-1 if indices is null) of the given type as triangles,
+	//	turning triangle strips into lists
+	static void appendIndices(const void* indices, size_t count, GLenum type, GLenum primitive, std::vector<GLuint>& triangles);
+	static std::unique_ptr<MeshRegistry> Create();
+	~MeshRegistry();
+	//meshes have to be added before upload()
+	//	Each mesh's triangles are reordered for the vertex cache (see optimizeVertexCache) as it's added.
+	//	A mesh with an index past its vertices isn't added, its handle has no indices to draw.
+	MeshHandle add(const std::vector<MeshVertex>& meshVertices, const std::vector<GLuint>& meshIndices);
+	//takes the mesh's position, normal and texture coordinate, strips become lists
+	MeshHandle add(const Mesh& mesh);
+	template<class T>
+	MeshHandle add(){
+		return add(Mesh::FromShape<T>());
+	}
+	//copies every mesh added so far to the GPU
+	void upload();
+	GLuint getVertexArray(){
+		return vao;
+	}
+	size_t getVertexCount(){
+		return vertices.size();
+	}
+	size_t getIndexCount(){
+		return indices.size();
+	}
+	//how every mesh added so far uses the vertex cache in the order it was given and in the order add() stored
+	void getVertexCacheStats(VertexCacheStats* before, VertexCacheStats* after) const;
+};
+
+//A frame's draws of registry meshes with one shader, issued by a single glMultiDrawElementsIndirect
+//	Each draw's InstanceData goes into a shader storage buffer, where the vertex shader finds it with gl_DrawIDARB:
+//		#extension GL_ARB_shader_draw_parameters : require
+//		layout(std430, binding = 0) readonly buffer DrawData { InstanceData draws[]; };
+//		... draws[gl_DrawIDARB].modelMatrix ...
+class MultiDrawBatch {
+private:
+	GLuint commandBuffer;
+	GLuint drawDataBuffer;
+	size_t capacity;
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<InstanceData> drawData;
+	MultiDrawBatch();
+public:
+	//returns an empty pointer if the context lacks multi draw indirect, shader storage buffers or gl_DrawIDARB
+	static std::unique_ptr<MultiDrawBatch> Create();
+	~MultiDrawBatch();
+	void add(const MeshHandle& mesh, const InstanceData& data);
+	//for filling the batch from several threads: resize once, then set each draw
+	void resize(size_t count);
+	void set(size_t index, const MeshHandle& mesh, const InstanceData& data){
+		commands[index] = DrawElementsIndirectCommand{mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, 0};
+		drawData[index] = data;
+	}
+	size_t size(){
+		return commands.size();
+	}
+	void clear();
+	//uploads the commands and draw data, binds the draw data at drawDataBinding and draws everything
+	void draw(MeshRegistry& registry, GLuint drawDataBinding = 0);
+};
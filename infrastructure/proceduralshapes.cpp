@@ -0,0 +1,355 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "proceduralshapes.h"
+#include "workerpool.h"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+const float pi = 3.14159265358979f;
+
+//The arrays a shape is generated into, sized up front so every worker writes its own slice without locking
+struct ShapeData {
+	std::vector<float> positions;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+	std::vector<GLuint> indices;
+	ShapeData(size_t vertexCount, size_t indexCount) : positions(vertexCount * 3), normals(vertexCount * 3), texCoords(vertexCount * 2), indices(indexCount) {}
+	void setVertex(size_t v, glm::vec3 position, glm::vec3 normal, glm::vec2 texCoord){
+		for(int c=0;c<3;c++){
+			positions[v*3+c] = position[c];
+			normals[v*3+c] = normal[c];
+		}
+		texCoords[v*2] = texCoord.x;
+		texCoords[v*2+1] = texCoord.y;
+	}
+	void setTriangle(size_t i, size_t a, size_t b, size_t c){
+		indices[i] = GLuint(a);
+		indices[i+1] = GLuint(b);
+		indices[i+2] = GLuint(c);
+	}
+	Mesh toMesh(){
+		Mesh mesh(GL_TRIANGLES);
+		mesh.setAttribute(PositionAttribute, 3, std::move(positions));
+		mesh.setAttribute(NormalAttribute, 3, std::move(normals));
+		mesh.setAttribute(TexCoordAttribute, 2, std::move(texCoords));
+		mesh.setIndices(std::move(indices));
+		return mesh;
+	}
+};
+
+bool fitsIndices(size_t vertexCount, const char* shape){
+	if(vertexCount > std::numeric_limits<GLuint>::max()){
+		printf("%s has too many vertices for 32 bit indices\n", shape);
+		return false;
+	}
+	return true;
+}
+
+//runs body(begin, end) over [0,count), split between the pool's workers if there is one
+template<class F>
+void forChunks(WorkerPool* pool, size_t count, const F& body){
+	if(pool == nullptr){
+		body(size_t(0), count);
+		return;
+	}
+	pool->parallelFor(count, [&](unsigned int, size_t begin, size_t end){
+		body(begin, end);
+	});
+}
+
+//cos and sin of count + 1 steps from 0 to the given angle, ending exactly where a full circle starts or half of one ends
+//	so seams and poles line up without cracks
+std::vector<glm::vec2> angleSteps(int count, bool fullCircle){
+	std::vector<glm::vec2> steps(count + 1);
+	float angle = fullCircle ? 2.f * pi : pi;
+	for(int i=0;i<count;i++){
+		float a = angle * float(i) / float(count);
+		steps[i] = glm::vec2(std::cos(a), std::sin(a));
+	}
+	steps[count] = fullCircle ? steps[0] : glm::vec2(-1.f, 0.f);
+	return steps;
+}
+
+struct SurfaceVertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+};
+
+//How many indices a columns by rows patch has, rows pinched to a single point (the poles of a sphere,
+//	the middle of a disc) lose the triangle of each quad that would have no area
+size_t surfaceIndices(int columns, int rows, bool pinchedFirst = false, bool pinchedLast = false){
+	return size_t(columns) * (size_t(rows) * 6 - (pinchedFirst ? 3 : 0) - (pinchedLast ? 3 : 0));
+}
+
+size_t surfaceVertices(int columns, int rows){
+	return (size_t(columns) + 1) * (size_t(rows) + 1);
+}
+
+//A columns by rows patch of quads starting at firstVertex and firstIndex
+//	point(x, y, vertex) fills in vertex (x, y), its texture coordinate starts out as (x / columns, y / rows).
+//	The quads wind counterclockwise seen from the side x cross y points to.
+template<class F>
+void writeSurface(ShapeData& data, size_t firstVertex, size_t firstIndex, int columns, int rows, bool pinchedFirst, bool pinchedLast,
+	const F& point, WorkerPool* pool){
+	size_t side = size_t(columns) + 1;
+	forChunks(pool, size_t(rows) + 1, [&](size_t begin, size_t end){
+		for(size_t y=begin;y<end;y++){
+			for(size_t x=0;x<side;x++){
+				SurfaceVertex vertex;
+				vertex.texCoord = glm::vec2(float(x) / float(columns), float(y) / float(rows));
+				point(x, y, vertex);
+				data.setVertex(firstVertex + y * side + x, vertex.position, vertex.normal, vertex.texCoord);
+			}
+		}
+	});
+	forChunks(pool, size_t(rows), [&](size_t begin, size_t end){
+		for(size_t y=begin;y<end;y++){
+			bool lower = !(pinchedFirst && y == 0), upper = !(pinchedLast && y + 1 == size_t(rows));
+			size_t i = firstIndex + y * columns * 6 - (pinchedFirst && y > 0 ? columns * 3 : 0);
+			for(size_t x=0;x<size_t(columns);x++){
+				size_t a = firstVertex + y * side + x;
+				if(lower){
+					data.setTriangle(i, a, a + 1, a + side + 1);
+					i += 3;
+				}
+				if(upper){
+					data.setTriangle(i, a, a + side + 1, a + side);
+					i += 3;
+				}
+			}
+		}
+	});
+}
+
+//where a vertex on the unit sphere lands on a texture wrapped around it like the UV sphere's
+glm::vec2 sphereTexCoord(glm::vec3 p){
+	float s = std::atan2(-p.z, p.x) / (2.f * pi);
+	return glm::vec2(s < 0.f ? s + 1.f : s, std::acos(glm::clamp(-p.y, -1.f, 1.f)) / pi);
+}
+}
+
+int segmentsForError(float radius, float maxError){
+	if(!(maxError < radius)){
+		return 3;
+	}
+	//an edge of a circle cut into n segments is radius * (1 - cos(pi / n)) from it at its middle
+	float segments = std::ceil(pi / std::acos(1.f - maxError / radius));
+	return segments < 3.f ? 3 : segments > 65536.f ? 65536 : int(segments);
+}
+
+Mesh generateGrid(int columns, int rows, WorkerPool* pool){
+	if(columns < 1 || rows < 1){
+		printf("A grid needs at least 1 column and 1 row\n");
+		return Mesh();
+	}
+	if(!fitsIndices(surfaceVertices(columns, rows), "The grid")){
+		return Mesh();
+	}
+	ShapeData data(surfaceVertices(columns, rows), surfaceIndices(columns, rows));
+	//y runs toward -z so the quads face up
+	writeSurface(data, 0, 0, columns, rows, false, false, [&](size_t, size_t, SurfaceVertex& vertex){
+		vertex.position = glm::vec3(vertex.texCoord.x * 2.f - 1.f, 0.f, 1.f - vertex.texCoord.y * 2.f);
+		vertex.normal = glm::vec3(0.f, 1.f, 0.f);
+	}, pool);
+	return data.toMesh();
+}
+
+Mesh generateUVSphere(int segments, int rings, WorkerPool* pool){
+	if(segments < 3 || rings < 2){
+		printf("A UV sphere needs at least 3 segments and 2 rings\n");
+		return Mesh();
+	}
+	if(!fitsIndices(surfaceVertices(segments, rings), "The UV sphere")){
+		return Mesh();
+	}
+	std::vector<glm::vec2> around = angleSteps(segments, true);
+	std::vector<glm::vec2> down = angleSteps(rings, false);
+	ShapeData data(surfaceVertices(segments, rings), surfaceIndices(segments, rings, true, true));
+	//from the -y pole up, so a quad's first two corners go counterclockwise seen from above
+	writeSurface(data, 0, 0, segments, rings, true, true, [&](size_t x, size_t y, SurfaceVertex& vertex){
+		float radius = down[y].y;
+		vertex.position = glm::vec3(around[x].x * radius, -down[y].x, -around[x].y * radius);
+		vertex.normal = vertex.position;
+	}, pool);
+	return data.toMesh();
+}
+
+Mesh generateTorus(int segments, int sides, float tubeRadius, WorkerPool* pool){
+	if(segments < 3 || sides < 3 || !(tubeRadius > 0.f && tubeRadius <= 0.5f)){
+		printf("A torus needs at least 3 segments and 3 sides and a tube radius up to 0.5\n");
+		return Mesh();
+	}
+	if(!fitsIndices(surfaceVertices(segments, sides), "The torus")){
+		return Mesh();
+	}
+	std::vector<glm::vec2> around = angleSteps(segments, true);
+	std::vector<glm::vec2> tube = angleSteps(sides, true);
+	float ringRadius = 1.f - tubeRadius;
+	ShapeData data(surfaceVertices(segments, sides), surfaceIndices(segments, sides));
+	writeSurface(data, 0, 0, segments, sides, false, false, [&](size_t x, size_t y, SurfaceVertex& vertex){
+		glm::vec3 outward(around[x].x, 0.f, -around[x].y);
+		vertex.normal = outward * tube[y].x + glm::vec3(0.f, tube[y].y, 0.f);
+		vertex.position = outward * ringRadius + vertex.normal * tubeRadius;
+	}, pool);
+	return data.toMesh();
+}
+
+Mesh generateCylinder(int segments, int stacks, WorkerPool* pool){
+	if(segments < 3 || stacks < 1){
+		printf("A cylinder needs at least 3 segments and 1 stack\n");
+		return Mesh();
+	}
+	size_t sideVertices = surfaceVertices(segments, stacks), capVertices = surfaceVertices(segments, 1);
+	size_t sideIndices = surfaceIndices(segments, stacks), capIndices = surfaceIndices(segments, 1, true);
+	if(!fitsIndices(sideVertices + 2 * capVertices, "The cylinder")){
+		return Mesh();
+	}
+	std::vector<glm::vec2> around = angleSteps(segments, true);
+	ShapeData data(sideVertices + 2 * capVertices, sideIndices + 2 * capIndices);
+	writeSurface(data, 0, 0, segments, stacks, false, false, [&](size_t x, size_t, SurfaceVertex& vertex){
+		vertex.normal = glm::vec3(around[x].x, 0.f, -around[x].y);
+		vertex.position = vertex.normal + glm::vec3(0.f, vertex.texCoord.y * 2.f - 1.f, 0.f);
+	}, pool);
+	//each cap is one ring of triangles around its middle, the bottom one going outward and the top one
+	//	inward to face away from the side; the texture is projected straight down onto them
+	for(int cap=0;cap<2;cap++){
+		float y = cap == 0 ? -1.f : 1.f;
+		writeSurface(data, sideVertices + cap * capVertices, sideIndices + cap * capIndices, segments, 1, cap == 0, cap == 1, [&](size_t x, size_t ring, SurfaceVertex& vertex){
+			float radius = float(cap == 0 ? ring : 1 - ring);
+			vertex.position = glm::vec3(around[x].x * radius, y, -around[x].y * radius);
+			vertex.normal = glm::vec3(0.f, y, 0.f);
+			vertex.texCoord = glm::vec2(vertex.position.x, vertex.position.z) * 0.5f + 0.5f;
+		}, nullptr);
+	}
+	return data.toMesh();
+}
+
+Mesh generateIcosphere(int divisions, WorkerPool* pool){
+	if(divisions < 1){
+		printf("An icosphere needs at least 1 division\n");
+		return Mesh();
+	}
+	const float t = 1.61803398875f;
+	const glm::vec3 corners[12] = {
+		glm::vec3(-1.f, t, 0.f), glm::vec3(1.f, t, 0.f), glm::vec3(-1.f, -t, 0.f), glm::vec3(1.f, -t, 0.f),
+		glm::vec3(0.f, -1.f, t), glm::vec3(0.f, 1.f, t), glm::vec3(0.f, -1.f, -t), glm::vec3(0.f, 1.f, -t),
+		glm::vec3(t, 0.f, -1.f), glm::vec3(t, 0.f, 1.f), glm::vec3(-t, 0.f, -1.f), glm::vec3(-t, 0.f, 1.f)
+	};
+	const int faces[20][3] = {
+		{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+		{1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+		{3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+		{4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+	};
+	//every vertex has one owner so shared edges come out identical: the 12 corners,
+	//	then divisions - 1 points along each of the 30 edges, then the points inside each face
+	int edges[12][12];
+	int edgeCorners[30][2];
+	int edgeCount = 0;
+	std::fill(&edges[0][0], &edges[0][0] + 144, -1);
+	for(int f=0;f<20;f++){
+		for(int e=0;e<3;e++){
+			int a = std::min(faces[f][e], faces[f][(e+1)%3]), b = std::max(faces[f][e], faces[f][(e+1)%3]);
+			if(edges[a][b] < 0){
+				edges[a][b] = edgeCount;
+				edgeCorners[edgeCount][0] = a;
+				edgeCorners[edgeCount][1] = b;
+				edgeCount++;
+			}
+		}
+	}
+	size_t d = size_t(divisions);
+	size_t edgePoints = d - 1, facePoints = (d - 1) * (d - 2) / 2;
+	size_t firstEdgePoint = 12, firstFacePoint = firstEdgePoint + 30 * edgePoints;
+	size_t vertexCount = firstFacePoint + 20 * facePoints;
+	if(!fitsIndices(vertexCount, "The icosphere")){
+		return Mesh();
+	}
+	ShapeData data(vertexCount, 20 * d * d * 3);
+	auto setPoint = [&](size_t v, glm::vec3 position){
+		position = glm::normalize(position);
+		data.setVertex(v, position, position, sphereTexCoord(position));
+	};
+	for(int c=0;c<12;c++){
+		setPoint(c, corners[c]);
+	}
+	//k steps of divisions from corner from toward corner to
+	auto edgePoint = [&](int from, int to, size_t k){
+		if(k == 0){
+			return size_t(from);
+		}
+		if(k == d){
+			return size_t(to);
+		}
+		if(from < to){
+			return firstEdgePoint + edges[from][to] * edgePoints + k - 1;
+		}
+		return firstEdgePoint + edges[to][from] * edgePoints + d - k - 1;
+	};
+	forChunks(pool, 30, [&](size_t begin, size_t end){
+		for(size_t e=begin;e<end;e++){
+			glm::vec3 a = corners[edgeCorners[e][0]], b = corners[edgeCorners[e][1]];
+			for(size_t k=1;k<d;k++){
+				setPoint(firstEdgePoint + e * edgePoints + k - 1, a + (b - a) * (float(k) / float(d)));
+			}
+		}
+	});
+	//point i steps toward a face's second corner and j toward its third
+	auto facePoint = [&](size_t f, size_t i, size_t j){
+		const int* corner = faces[f];
+		if(j == 0){
+			return edgePoint(corner[0], corner[1], i);
+		}
+		if(i == 0){
+			return edgePoint(corner[0], corner[2], j);
+		}
+		if(i + j == d){
+			return edgePoint(corner[1], corner[2], j);
+		}
+		return firstFacePoint + f * facePoints + (j - 1) * (d - 1) - (j - 1) * j / 2 + i - 1;
+	};
+	//one chunk item is one row of triangles of one face, so even a handful of divisions spreads across the workers
+	forChunks(pool, 20 * d, [&](size_t begin, size_t end){
+		for(size_t item=begin;item<end;item++){
+			size_t f = item / d, j = item % d;
+			glm::vec3 a = corners[faces[f][0]], b = corners[faces[f][1]], c = corners[faces[f][2]];
+			for(size_t i=1;j>0 && i+j<d;i++){
+				setPoint(facePoint(f, i, j), a + (b - a) * (float(i) / float(d)) + (c - a) * (float(j) / float(d)));
+			}
+			size_t index = (f * d * d + j * (2 * d - j)) * 3;
+			for(size_t i=0;i+j<d;i++){
+				data.setTriangle(index, facePoint(f, i, j), facePoint(f, i + 1, j), facePoint(f, i, j + 1));
+				index += 3;
+				if(i + j + 1 < d){
+					data.setTriangle(index, facePoint(f, i + 1, j), facePoint(f, i + 1, j + 1), facePoint(f, i, j + 1));
+					index += 3;
+				}
+			}
+		}
+	});
+	return data.toMesh();
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include "mesh.h"
+
+class WorkerPool;
+
+//Shapes with a chosen level of detail, built at load time instead of loaded from an asset
+//	Every shape has a position, normal and texture coordinate per vertex (see VertexLayout::Interleaved),
+//	counterclockwise triangles seen from outside and fits in -1 to 1 like SharpCube.
+//	With a WorkerPool the vertices and indices are generated in chunks across its workers,
+//	each writing straight into its own part of the mesh's arrays.
+//	Bad parameters print a message and give an empty mesh.
+//	Rows of triangles miss the vertex cache about once a triangle, Mesh::optimizeVertexCache brings that to about 0.7.
+
+//How many segments a circle of the given radius needs so none of its edges is further than maxError from it,
+//	to pick a level of detail from how big a shape is on screen
+int segmentsForError(float radius, float maxError);
+
+//columns by rows quads across the y = 0 plane, facing +y like Grid in geometry.h
+Mesh generateGrid(int columns, int rows, WorkerPool* pool = nullptr);
+//segments around the y axis and rings from pole to pole, rings = segments / 2 keeps the quads square at the equator
+Mesh generateUVSphere(int segments, int rings, WorkerPool* pool = nullptr);
+//an icosahedron with every edge split into divisions, 20 * divisions^2 triangles of nearly the same size
+//	Splitting each triangle in four n times is divisions = 2^n. Vertices are shared, so the texture
+//	(mapped like the UV sphere's) is stretched across one column of triangles at the seam.
+Mesh generateIcosphere(int divisions, WorkerPool* pool = nullptr);
+//a ring around the y axis reaching out to 1, segments around the ring and sides around a tube of tubeRadius up to 0.5
+Mesh generateTorus(int segments, int sides, float tubeRadius, WorkerPool* pool = nullptr);
+//segments around the y axis, stacks along its height, with flat caps
+Mesh generateCylinder(int segments, int stacks, WorkerPool* pool = nullptr);
@@ -0,0 +1,170 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "programcache.h"
+#include "glloader.h"
+#include "glrecorder.h"
+#include "gltrace.h"
+#include "fileview.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+static const char binaryMagic[4] = {'G','L','P','B'};
+static const uint32_t binaryVersion = 1;
+
+static bool checked = false;
+static bool enabled = false;
+static std::string directory;
+
+uint64_t hashProgramData(uint64_t hash, const void* data, size_t size){
+	const unsigned char* bytes = (const unsigned char*)data;
+	for(size_t i=0;i<size;i++){
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool isProgramBinaryCacheEnabled(){
+#ifdef __EMSCRIPTEN__
+	return false;
+#else
+	if(checked){
+		return enabled;
+	}
+	checked = true;
+	const char* setting = getenv("DEMO_SHADER_CACHE");
+	if(setting && std::string(setting) == "0"){
+		return false;
+	}
+	if(isRecordingGL() || isTracingGL()){
+		return false;
+	}
+	if(!(hasGLVersion(4,1) || hasGLExtension("GL_ARB_get_program_binary"))){
+		return false;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+	if(formats == 0){
+		return false;
+	}
+	directory = setting ? setting : "shadercache";
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+	enabled = true;
+	return true;
+#endif
+}
+
+uint64_t programBinaryKeySeed(){
+	uint64_t hash = programHashSeed;
+	const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+	for(GLenum name : names){
+		const char* value = (const char*)glGetString(name);
+		if(value){
+			hash = hashProgramData(hash, value, strlen(value) + 1);
+		}
+	}
+	return hash;
+}
+
+static std::string binaryPath(uint64_t key){
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return directory + "/" + name;
+}
+
+//file layout: magic, version, key, binary format, binary length, binary
+bool loadProgramBinary(uint64_t key, GLuint program){
+	if(!isProgramBinaryCacheEnabled()){
+		return false;
+	}
+	std::unique_ptr<FileView> file = FileView::Create(binaryPath(key));
+	if(!file){
+		return false;
+	}
+	//the header is read out of the mapping, the binary itself goes to the driver straight from it
+	char magic[4];
+	uint32_t version = 0, length = 0;
+	uint64_t storedKey = 0;
+	GLenum format = 0;
+	const size_t headerSize = sizeof(magic) + sizeof(version) + sizeof(storedKey) + sizeof(format) + sizeof(length);
+	if(file->size() < headerSize){
+		return false;
+	}
+	const char* read = file->data();
+	auto get = [&](void* value, size_t size){
+		memcpy(value, read, size);
+		read += size;
+	};
+	get(magic, sizeof(magic));
+	get(&version, sizeof(version));
+	get(&storedKey, sizeof(storedKey));
+	get(&format, sizeof(format));
+	get(&length, sizeof(length));
+	if(memcmp(magic, binaryMagic, sizeof(magic)) != 0 || version != binaryVersion || storedKey != key
+		|| length == 0 || length > file->size() - headerSize){
+		return false;
+	}
+	glProgramBinary(program, format, read, GLsizei(length));
+	//drivers reject binaries they no longer understand, the program then just gets linked from source
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	return linked == GL_TRUE;
+}
+
+void storeProgramBinary(uint64_t key, GLuint program){
+	if(!isProgramBinaryCacheEnabled()){
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0){
+		return;
+	}
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+	FILE* file = fopen(binaryPath(key).c_str(), "wb");
+	if(!file){
+		printf("couldn't write %s\n", binaryPath(key).c_str());
+		return;
+	}
+	uint32_t size = uint32_t(length);
+	fwrite(binaryMagic, sizeof(binaryMagic), 1, file);
+	fwrite(&binaryVersion, sizeof(binaryVersion), 1, file);
+	fwrite(&key, sizeof(key), 1, file);
+	fwrite(&format, sizeof(format), 1, file);
+	fwrite(&size, sizeof(size), 1, file);
+	fwrite(binary.data(), 1, size, file);
+	fclose(file);
+}
@@ -0,0 +1,45 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include <cstddef>
+#include <cstdint>
+
+//Keeps linked programs on disk (glGetProgramBinary) so later runs can skip compiling and linking them
+//	Entries are keyed by a hash of everything that goes into the program plus the driver's vendor, renderer and version,
+//	so an edited shader or a driver update just makes a new entry.
+//	On by default in ./shadercache, DEMO_SHADER_CACHE=0 turns it off and any other value is the directory to use.
+//	Always off with the recording backend or while tracing, neither of them can replay a binary.
+
+//64 bit FNV-1a, chain calls by passing the previous result as the hash
+const uint64_t programHashSeed = 14695981039346656037ull;
+uint64_t hashProgramData(uint64_t hash, const void* data, size_t size);
+
+//checks for GL_ARB_get_program_binary and the environment the first time it is called
+bool isProgramBinaryCacheEnabled();
+//a hash of the driver strings to start a program's key from
+uint64_t programBinaryKeySeed();
+//returns true if program now holds the cached binary and is linked
+bool loadProgramBinary(uint64_t key, GLuint program);
+//writes a linked program out, it has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+void storeProgramBinary(uint64_t key, GLuint program);
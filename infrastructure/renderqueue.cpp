@@ -0,0 +1,249 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "renderqueue.h"
+#include "commandlist.h"
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static uint16_t nextMaterialId = 0;
+
+Material::Material(){
+	id = nextMaterialId++;
+}
+
+Material::Value& Material::find(GLint location, GLenum type){
+	for(Value& value : values){
+		if(value.location == location){
+			value.type = type;
+			return value;
+		}
+	}
+	values.push_back(Value());
+	values.back().location = location;
+	values.back().type = type;
+	return values.back();
+}
+
+void Material::set(GLint location, GLint value){
+	memcpy(find(location, GL_INT).data, &value, sizeof(value));
+}
+void Material::set(GLint location, GLfloat value){
+	find(location, GL_FLOAT).data[0] = value;
+}
+void Material::set(GLint location, const glm::vec3& value){
+	memcpy(find(location, GL_FLOAT_VEC3).data, glm::value_ptr(value), sizeof(value));
+}
+void Material::set(GLint location, const glm::vec4& value){
+	memcpy(find(location, GL_FLOAT_VEC4).data, glm::value_ptr(value), sizeof(value));
+}
+void Material::set(GLint location, const glm::mat4& value){
+	memcpy(find(location, GL_FLOAT_MAT4).data, glm::value_ptr(value), sizeof(value));
+}
+
+void Material::apply() const {
+	for(const Value& value : values){
+		switch(value.type){
+		case GL_INT: {
+			GLint i;
+			memcpy(&i, value.data, sizeof(i));
+			glUniform1i(value.location, i);
+			break;
+		}
+		case GL_FLOAT:
+			glUniform1f(value.location, value.data[0]);
+			break;
+		case GL_FLOAT_VEC3:
+			glUniform3fv(value.location, 1, value.data);
+			break;
+		case GL_FLOAT_VEC4:
+			glUniform4fv(value.location, 1, value.data);
+			break;
+		case GL_FLOAT_MAT4:
+			glUniformMatrix4fv(value.location, 1, GL_FALSE, value.data);
+			break;
+		}
+	}
+}
+
+RenderQueue::RenderQueue(std::string modelMatrixName) : modelMatrixName(modelMatrixName), drawDataRing(nullptr), drawDataBinding(0) {
+	memset(&stats, 0, sizeof(stats));
+}
+
+void RenderQueue::add(const RenderPacket& packet){
+	uint64_t depthBits = uint64_t(glm::clamp(packet.depth, 0.f, 1.f) * 65535.f);
+	uint64_t key = (uint64_t(packet.layer & 0xF) << 60)
+		| (uint64_t(packet.shader->getId() & 0xFFF) << 48)
+		| (uint64_t(packet.material->getId()) << 32)
+		| (uint64_t(packet.mesh.vao & 0xFFFF) << 16)
+		| depthBits;
+	entries.push_back(SortEntry{key, uint32_t(packets.size())});
+	packets.push_back(packet);
+}
+
+void RenderQueue::submit(Shader& shader, const Material& material, const DrawCall& mesh, const glm::mat4& transform, unsigned int layer, float depth){
+	add(RenderPacket{&shader, &material, mesh, transform, layer, depth});
+}
+
+void RenderQueue::streamDrawData(RingBuffer* ring, GLuint binding){
+	drawDataRing = ring;
+	drawDataBinding = binding;
+}
+
+void RenderQueue::setLayerState(unsigned int layer, std::function<void()> state){
+	layerStates[layer & 0xF] = state;
+}
+
+void RenderQueue::submit(const CommandList& list){
+	packets.reserve(packets.size() + list.size());
+	entries.reserve(entries.size() + list.size());
+	for(const RenderPacket& packet : list.getPackets()){
+		add(packet);
+	}
+}
+
+//Least significant digit radix sort, a byte at a time
+//	Bytes that are the same in every key (most of them, with only a few programs and meshes) are skipped.
+void RenderQueue::sort(){
+	size_t count = entries.size();
+	scratch.resize(count);
+	for(int shift=0;shift<64;shift+=8){
+		size_t histogram[256] = {0};
+		for(size_t i=0;i<count;i++){
+			histogram[(entries[i].key >> shift) & 0xFF]++;
+		}
+		if(histogram[(entries[0].key >> shift) & 0xFF] == count){
+			continue;
+		}
+		size_t offset = 0;
+		for(int b=0;b<256;b++){
+			size_t bucket = histogram[b];
+			histogram[b] = offset;
+			offset += bucket;
+		}
+		for(size_t i=0;i<count;i++){
+			scratch[histogram[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+		}
+		entries.swap(scratch);
+	}
+}
+
+void RenderQueue::execute(){
+	memset(&stats, 0, sizeof(stats));
+	if(packets.empty()){
+		return;
+	}
+	sort();
+	//all of the draw data that fits is written and flushed in one go before the first draw
+	char* records = nullptr;
+	size_t streamed = 0;
+	GLintptr recordsOffset = 0;
+	GLsizeiptr recordSize = 0, recordStride = 0;
+	if(drawDataRing){
+		size_t largest = 0;
+		for(const RenderPacket& packet : packets){
+			largest = std::max(largest, packet.material->getDrawData().size());
+		}
+		//std140 blocks are a multiple of 16 bytes, and so is the range bound for them
+		recordSize = GLsizeiptr(sizeof(glm::mat4) + largest + 15) / 16 * 16;
+		recordStride = (recordSize + drawDataRing->getAlignment() - 1) / drawDataRing->getAlignment() * drawDataRing->getAlignment();
+		streamed = std::min(entries.size(), size_t(drawDataRing->getAvailable() / recordStride));
+		if(streamed > 0){
+			records = (char*)drawDataRing->allocate(recordStride * streamed, recordsOffset);
+		}
+		if(!records){
+			streamed = 0;
+		}
+		char* record = records;
+		for(size_t i=0;i<streamed;i++){
+			const RenderPacket& packet = packets[entries[i].packet];
+			const std::vector<char>& drawData = packet.material->getDrawData();
+			memcpy(record, glm::value_ptr(packet.transform), sizeof(glm::mat4));
+			if(!drawData.empty()){
+				memcpy(record + sizeof(glm::mat4), drawData.data(), drawData.size());
+			}
+			record += recordStride;
+		}
+		drawDataRing->flush();
+	}
+	Shader* shader = nullptr;
+	const Material* material = nullptr;
+	GLuint vao = 0;
+	//looked up the first time a draw of the program needs it
+	GLint modelMatrixLocation = -1;
+	bool locationKnown = false;
+	GLintptr recordOffset = recordsOffset;
+	unsigned int layer = 0;
+	for(size_t i=0;i<entries.size();i++){
+		const RenderPacket& packet = packets[entries[i].packet];
+		if((i == 0 || (packet.layer & 0xF) != layer) && layerStates[packet.layer & 0xF]){
+			layerStates[packet.layer & 0xF]();
+		}
+		layer = packet.layer & 0xF;
+		bool programChanged = packet.shader != shader;
+		if(programChanged){
+			shader = packet.shader;
+			shader->bind();
+			locationKnown = false;
+			stats.programChanges++;
+		}
+		bool fromRing = i < streamed;
+		if(!fromRing && !locationKnown){
+			modelMatrixLocation = shader->getUniformLocation(modelMatrixName);
+			locationKnown = true;
+		}
+		if(drawDataRing && !fromRing && modelMatrixLocation < 0){
+			stats.dropped++;
+			continue;
+		}
+		//uniforms belong to the program, so a new program needs the material again even if it is the same one
+		if(programChanged || packet.material != material){
+			material = packet.material;
+			material->apply();
+			stats.materialChanges++;
+		}
+		if(stats.draws == 0 || packet.mesh.vao != vao){
+			vao = packet.mesh.vao;
+			glBindVertexArray(vao);
+			stats.meshChanges++;
+		}
+		if(fromRing){
+			drawDataRing->bindRange(drawDataBinding, recordOffset, recordSize);
+			recordOffset += recordStride;
+		} else {
+			glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(packet.transform));
+		}
+		if(packet.mesh.indexType == 0){
+			glDrawArrays(packet.mesh.primitive, 0, packet.mesh.count);
+		} else {
+			glDrawElements(packet.mesh.primitive, packet.mesh.count, packet.mesh.indexType, 0);
+		}
+		stats.draws++;
+	}
+	if(drawDataRing && streamed < entries.size()){
+		printf("%zu of %zu draws didn't fit in the draw data ring (%d byte records), %u dropped for want of a %s uniform\n",
+			entries.size() - streamed, entries.size(), int(recordStride), stats.dropped, modelMatrixName.c_str());
+	}
+	packets.clear();
+	entries.clear();
+}
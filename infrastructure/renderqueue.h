@@ -0,0 +1,139 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include "geometry.h"
+#include "shader.h"
+#include "ringbuffer.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//A set of uniform values that are uploaded together whenever a draw using them follows a draw that didn't
+//	Locations are those of the shader the material is drawn with.
+class Material {
+private:
+	struct Value {
+		GLint location;
+		GLenum type;
+		GLfloat data[16];
+	};
+	std::vector<Value> values;
+	std::vector<char> drawData;
+	uint16_t id;
+	Value& find(GLint location, GLenum type);
+public:
+	Material();
+	void set(GLint location, GLint value);
+	void set(GLint location, GLfloat value);
+	void set(GLint location, const glm::vec3& value);
+	void set(GLint location, const glm::vec4& value);
+	void set(GLint location, const glm::mat4& value);
+	//uploads every value to the bound program
+	void apply() const;
+	//when the queue streams draw data, the std140 members that follow the model matrix in the DrawData block
+	template<class T>
+	void setDrawData(const T& data){
+		drawData.assign((const char*)&data, (const char*)&data + sizeof(T));
+	}
+	const std::vector<char>& getDrawData() const {
+		return drawData;
+	}
+	uint16_t getId() const {
+		return id;
+	}
+};
+
+struct RenderPacket {
+	Shader* shader;
+	const Material* material;
+	DrawCall mesh;
+	glm::mat4 transform;
+	unsigned int layer;
+	float depth;
+};
+
+class CommandList;
+
+struct RenderQueueStats {
+	unsigned int draws;
+	unsigned int programChanges;
+	unsigned int materialChanges;
+	unsigned int meshChanges;
+	//draws whose draw data didn't fit in the ring and whose program has no model matrix uniform to fall back to
+	unsigned int dropped;
+};
+
+//Collects a frame's draws and issues them sorted by state, so each program, material and mesh is set as few times as possible
+//	The 64 bit sort key is, from the most significant bits down:
+//	layer (4 bits), program (12), material (16), vertex array (16), depth (16)
+//	GL names wider than their field only cost batching, execute() still compares the real values.
+class RenderQueue {
+private:
+	struct SortEntry {
+		uint64_t key;
+		uint32_t packet;
+	};
+	std::vector<RenderPacket> packets;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	std::string modelMatrixName;
+	RingBuffer* drawDataRing;
+	GLuint drawDataBinding;
+	std::function<void()> layerStates[16];
+	RenderQueueStats stats;
+	void sort();
+	void add(const RenderPacket& packet);
+public:
+	//transform is uploaded to the uniform of this name in each shader
+	RenderQueue(std::string modelMatrixName = "modelMatrix");
+	//layer orders groups of draws (0-15, lowest first), depth in [0,1] orders draws within a batch (front to back for opaque geometry)
+	void submit(Shader& shader, const Material& material, const DrawCall& mesh, const glm::mat4& transform, unsigned int layer = 0, float depth = 0.f);
+	//adds every packet recorded in the list, in order
+	void submit(const CommandList& list);
+	//Instead of glUniform calls, each draw's transform followed by its material's draw data is written to ring
+	//	and bound to the uniform buffer binding with glBindBufferRange, for shaders declaring
+	//	layout(std140) uniform DrawData { mat4 modelMatrix; ...material members... };
+	//	The ring's frames are left to the caller, nullptr goes back to uniforms.
+	//	A region holds frameSize / (64 bytes plus the largest draw data, rounded up to the ring's alignment) records,
+	//	about 4096 with a 1MB frame and the usual 256 byte uniform buffer alignment. Draws past that are given their
+	//	transform through the modelMatrixName uniform, or dropped (and counted in the stats) if the program has none.
+	void streamDrawData(RingBuffer* ring, GLuint binding);
+	//execute() calls state before the first draw of layer, for render state that changes between passes
+	//	(a depth prepass writing only depth in one layer, the shading pass testing GL_EQUAL in the next)
+	//	Whatever it sets stays set after execute().
+	void setLayerState(unsigned int layer, std::function<void()> state);
+	//sorts and issues everything submitted since the last execute
+	//	Uniforms shared by every draw of a shader (view, projection...) can be set on it beforehand,
+	//	they are kept with the program.
+	void execute();
+	size_t size(){
+		return packets.size();
+	}
+	//counters of the last execute
+	const RenderQueueStats& getStats(){
+		return stats;
+	}
+};
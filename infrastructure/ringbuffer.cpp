@@ -0,0 +1,149 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "ringbuffer.h"
+#include <cstdio>
+
+static GLint offsetAlignment(GLenum target){
+	GLint alignment = 0;
+	switch(target){
+	case GL_UNIFORM_BUFFER:
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+		break;
+#ifndef __EMSCRIPTEN__
+	case GL_SHADER_STORAGE_BUFFER:
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,&alignment);
+		break;
+#endif
+	}
+	//std140 aligns everything to at most 16 bytes anyway
+	return alignment > 16 ? alignment : 16;
+}
+
+RingBuffer::RingBuffer(GLenum target, GLsizeiptr regionSize, unsigned int regionCount)
+	: target(target), regionSize(regionSize), regionCount(regionCount), region(0), head(0), flushed(0),
+	persistent(false), memory(nullptr), fences(regionCount, nullptr), stalls(0), full(false) {
+	alignment = offsetAlignment(target);
+	GLsizeiptr size = regionSize * regionCount;
+	glGenBuffers(1,&buffer);
+	glBindBuffer(target,buffer);
+#ifndef __EMSCRIPTEN__
+	if(glBufferStorage){
+		//flushed explicitly rather than coherent, so the driver knows exactly which bytes changed (and traces can see them)
+		glBufferStorage(target,size,nullptr,GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
+		memory = (char*)glMapBufferRange(target,0,size,GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+		persistent = memory != nullptr;
+		if(!persistent){
+			//storage is immutable, start over with a buffer that can be reallocated
+			printf("mapping the ring buffer failed, falling back to glBufferSubData\n");
+			glDeleteBuffers(1,&buffer);
+			glGenBuffers(1,&buffer);
+			glBindBuffer(target,buffer);
+		}
+	}
+#endif
+	if(!persistent){
+		glBufferData(target,size,nullptr,GL_STREAM_DRAW);
+		staging.resize(size);
+		memory = staging.data();
+	}
+}
+
+std::unique_ptr<RingBuffer> RingBuffer::Create(GLenum target, GLsizeiptr frameSize, unsigned int framesInFlight){
+	if(frameSize <= 0 || framesInFlight == 0){
+		printf("a ring buffer needs room for at least one frame\n");
+		return std::unique_ptr<RingBuffer>();
+	}
+	return std::unique_ptr<RingBuffer>(new RingBuffer(target, frameSize, framesInFlight));
+}
+
+RingBuffer::~RingBuffer(){
+	for(GLsync fence : fences){
+		if(fence){
+			glDeleteSync(fence);
+		}
+	}
+	if(persistent){
+		glBindBuffer(target,buffer);
+		glUnmapBuffer(target);
+	}
+	glDeleteBuffers(1,&buffer);
+}
+
+void RingBuffer::beginFrame(){
+	GLsync& fence = fences[region];
+	if(fence){
+		//a zero timeout only checks, anything else means the CPU got a whole ring ahead of the GPU
+		GLenum result = glClientWaitSync(fence,0,0);
+		if(result == GL_TIMEOUT_EXPIRED){
+			stalls++;
+			do {
+				result = glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000000);
+			} while(result == GL_TIMEOUT_EXPIRED);
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	head = flushed = region * regionSize;
+	full = false;
+}
+
+void* RingBuffer::allocate(GLsizeiptr size, GLintptr& offset){
+	GLintptr start = (head + alignment - 1) / alignment * alignment;
+	if(start + size > GLintptr(region + 1) * regionSize){
+		if(!full){
+			printf("ring buffer region of %d bytes is full\n", int(regionSize));
+			full = true;
+		}
+		return nullptr;
+	}
+	head = start + size;
+	offset = start;
+	return memory + start;
+}
+
+GLsizeiptr RingBuffer::getAvailable(){
+	GLintptr start = (head + alignment - 1) / alignment * alignment;
+	GLintptr end = GLintptr(region + 1) * regionSize;
+	return start < end ? end - start : 0;
+}
+
+void RingBuffer::flush(){
+	if(head == flushed){
+		return;
+	}
+	glBindBuffer(target,buffer);
+	if(persistent){
+		glFlushMappedBufferRange(target,flushed,head - flushed);
+	} else {
+		glBufferSubData(target,flushed,head - flushed,memory + flushed);
+	}
+	flushed = head;
+}
+
+void RingBuffer::endFrame(){
+	flush();
+	//glBufferSubData is ordered by the driver, only writes through the mapping need fencing
+	if(persistent){
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+	}
+	region = (region + 1) % regionCount;
+}
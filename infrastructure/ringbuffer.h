@@ -0,0 +1,96 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include <memory>
+#include <vector>
+
+//Hands out short lived pieces of one buffer for data the GPU reads once (per draw uniforms and the like)
+//	The buffer is split into a region per frame in flight. A region is fenced at the end of its frame
+//	and only written again once the GPU is past that fence, so the CPU never waits on draws still in flight.
+//	With glBufferStorage the buffer stays mapped for its whole life and writes go straight to it,
+//	otherwise (WebGL, older drivers) they are staged and uploaded with one glBufferSubData per flush.
+class RingBuffer {
+private:
+	GLenum target;
+	GLuint buffer;
+	GLsizeiptr regionSize;
+	unsigned int regionCount;
+	unsigned int region;
+	GLint alignment;
+	//next free byte and the first one not flushed yet, both from the start of the buffer
+	GLintptr head;
+	GLintptr flushed;
+	bool persistent;
+	//the persistent mapping or staging.data()
+	char* memory;
+	std::vector<char> staging;
+	std::vector<GLsync> fences;
+	unsigned int stalls;
+	bool full;
+	RingBuffer(GLenum target, GLsizeiptr regionSize, unsigned int regionCount);
+public:
+	//frameSize bytes can be allocated per frame, with framesInFlight frames being written or read at once
+	static std::unique_ptr<RingBuffer> Create(GLenum target, GLsizeiptr frameSize, unsigned int framesInFlight = 3);
+	~RingBuffer();
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+	//moves on to the next region, waiting for the GPU if it is still reading it
+	void beginFrame();
+	//returns memory to write size bytes to and its offset in the buffer, aligned for glBindBufferRange
+	//	nullptr if the frame's region is full
+	void* allocate(GLsizeiptr size, GLintptr& offset);
+	//how many bytes allocate can still hand out in this frame's region, starting from an aligned offset
+	GLsizeiptr getAvailable();
+	//copies value in, returns its offset or -1 if the region is full
+	template<class T>
+	GLintptr push(const T& value){
+		GLintptr offset;
+		T* destination = (T*)allocate(sizeof(T), offset);
+		if(!destination){
+			return -1;
+		}
+		*destination = value;
+		return offset;
+	}
+	//makes everything allocated since the last flush visible to the GPU, has to come before the draws that read it
+	void flush();
+	//flushes and fences the frame's region
+	void endFrame();
+	void bindRange(GLuint index, GLintptr offset, GLsizeiptr size){
+		glBindBufferRange(target,index,buffer,offset,size);
+	}
+	GLuint getId(){
+		return buffer;
+	}
+	GLint getAlignment(){
+		return alignment;
+	}
+	bool isPersistent(){
+		return persistent;
+	}
+	//how many times beginFrame had to wait for the GPU
+	unsigned int getStallCount(){
+		return stalls;
+	}
+};
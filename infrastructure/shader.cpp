@@ -20,24 +20,106 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ***************************************************************************/
 #include "shader.h"
-#include <fstream>
+#include "programcache.h"
+#include "filewatcher.h"
+#include "embeddedshaders.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
-bool ShaderStage::compile(std::string source)
-{
+void ShaderStage::load(std::string source, std::string name){
+	this->source = source;
+	this->name = name;
+	sources.assign(1, name);
+	started = false;
+	compiled = false;
+}
+
+bool ShaderStage::loadFromFile(std::string filename, const ShaderDefines& defines){
+	std::string s;
+	std::vector<std::string> files;
+	if(!preprocessShaderFile(filename, defines, s, files)){
+		return false;
+	}
+	load(s, filename);
+	sources = files;
+	this->defines = defines;
+	watchSources();
+	return true;
+}
+
+void ShaderStage::watchSources(){
+	versions.clear();
+	for(auto& file : sources){
+		//editing the file doesn't change the copy compiled into the program
+		if(!isEmbeddedShader(file)){
+			watchFile(file);
+		}
+		versions.push_back(fileVersion(file));
+	}
+}
+
+bool ShaderStage::refresh(){
+	bool changed = false;
+	for(size_t i = 0; i < versions.size(); i++){
+		changed = changed || fileVersion(sources[i]) != versions[i];
+	}
+	if(!changed){
+		return false;
+	}
+	std::string s;
+	std::vector<std::string> files;
+	if(!preprocessShaderFile(name, defines, s, files)){
+		//try again on the next change
+		watchSources();
+		return false;
+	}
+	//deleting a shader object that is attached to a program only flags it, so the linked programs are fine
+	glDeleteShader(id);
+	id = glCreateShader(type);
+	load(s, name);
+	sources = files;
+	watchSources();
+	generation++;
+	startCompile();
+	return true;
+}
+
+void ShaderStage::startCompile(){
+	if(started){
+		return;
+	}
+	if(!name.empty()){
+		std::cout << "compiling " << name << std::endl;
+	}
 	const char* src = source.c_str();
 	int len = source.size();
 	glShaderSource(id,1,&src,&len);
 	glCompileShader(id);
+	started = true;
+}
+
+bool ShaderStage::compile()
+{
+	if(compiled){
+		return true;
+	}
+	startCompile();
 	int compiled;
 	glGetShaderiv(id, GL_COMPILE_STATUS, &compiled);
 	GLsizei length;
 	glGetShaderiv(id,GL_INFO_LOG_LENGTH,&length);
-	GLchar* buff = new GLchar[length];
+	GLchar* buff = new GLchar[length + 1];
+	buff[0] = '\0';
 	glGetShaderInfoLog(id,length,&length,buff);
 	//do something with error log
 	if (strlen(buff) > 0){
 		std::cout << buff << std::endl;
+		//the log only has source string numbers
+		for(size_t i = 1; i < sources.size(); i++){
+			printf("  source %zu is %s\n", i, sources[i].c_str());
+		}
 	}
 	delete[] buff;
 	if (compiled != GL_TRUE)
@@ -45,31 +127,93 @@ bool ShaderStage::compile(std::string source)
 		//shader failed to compile
 		return false;
 	} 
+	this->compiled = true;
 	return true;
 }
 
-bool ShaderStage::compileFromFile(std::string filename){
-	std::ifstream file(filename);
-	if(!file.is_open()){
-		return false;
+bool ShaderStage::compile(std::string source){
+	load(source);
+	return compile();
+}
+
+bool ShaderStage::compileFromFile(std::string filename, const ShaderDefines& defines){
+	return loadFromFile(filename, defines) && compile();
+}
+
+uint64_t Shader::binaryKey(){
+	uint64_t key = programBinaryKeySeed();
+	for(auto& stage : stages){
+		GLenum type = stage->getType();
+		key = hashProgramData(key, &type, sizeof(type));
+		key = hashProgramData(key, stage->getSource().data(), stage->getSource().size());
+	}
+	for(auto& attribute : attributes){
+		key = hashProgramData(key, &attribute.first, sizeof(attribute.first));
+		key = hashProgramData(key, attribute.second.c_str(), attribute.second.size() + 1);
 	}
-	std::istreambuf_iterator<char> eos;
-	std::string s(std::istreambuf_iterator<char>(file), eos);
-	std::cout << "compiling " << filename << std::endl;
-	return compile(s);
+	return key;
 }
 
-bool Shader::link(){
+void Shader::linkAsync(){
+	linkStart = std::chrono::high_resolution_clock::now();
+	linking = true;
+	linkedGenerations.clear();
+	for(auto& stage : stages){
+		linkedGenerations.push_back(stage->getGeneration());
+	}
+	fromCache = false;
+	if(isProgramBinaryCacheEnabled()){
+		key = binaryKey();
+		fromCache = loadProgramBinary(key, id);
+		if(fromCache){
+			return;
+		}
+	}
+	//compile errors are picked up in finishLink, a failed stage fails the link anyway
 	for(auto it = stages.begin(); it != stages.end(); it++){
+		(*it)->startCompile();
 		glAttachShader(id,(*it)->getId());
 	}
+	if(isProgramBinaryCacheEnabled()){
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(id);
+}
+
+bool Shader::isReady(){
+	if(!linking || fromCache || !glMaxShaderCompilerThreadsKHR){
+		return true;
+	}
+	GLint done = GL_FALSE;
+	glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &done);
+	return done == GL_TRUE;
+}
+
+bool Shader::finishLink(){
+	if(!linking){
+		linkAsync();
+	}
+	linking = false;
+	auto milliseconds = [&](){
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - linkStart).count();
+	};
+	if(fromCache){
+		reflect();
+		printf("program %u: %.2f ms from the binary cache\n", id, milliseconds());
+		return true;
+	}
+	for(auto it = stages.begin(); it != stages.end(); it++){
+		if(!(*it)->compile()){
+			return false;
+		}
+	}
 	int linked;
 		
 	glGetProgramiv(id,GL_LINK_STATUS, &linked);
 	GLsizei length;
 	glGetProgramiv(id,GL_INFO_LOG_LENGTH,&length);
-	GLchar* buff = new GLchar[length];
+	GLchar* buff = new GLchar[length + 1];
+	buff[0] = '\0';
 	glGetProgramInfoLog(id,length,&length,buff);
 	//do something with error log
 	if (strlen(buff) > 0){
@@ -81,21 +225,187 @@ bool Shader::link(){
 		//shader failed to link
 		return false;
 	}
+	if(isProgramBinaryCacheEnabled()){
+		storeProgramBinary(key, id);
+	}
+	reflect();
+	printf("program %u: %.2f ms to compile and link\n", id, milliseconds());
+	return true;
+}
 
+bool Shader::reload(){
+	if(!pendingId){
+		bool changed = false;
+		for(size_t i = 0; i < stages.size(); i++){
+			//a stage shared with another program may have been refreshed by that program's reload already
+			stages[i]->refresh();
+			changed = changed || i >= linkedGenerations.size() || stages[i]->getGeneration() != linkedGenerations[i];
+		}
+		if(!changed){
+			return false;
+		}
+		reloadStart = std::chrono::high_resolution_clock::now();
+		pendingId = glCreateProgram();
+		pendingGenerations.clear();
+		for(auto& stage : stages){
+			stage->startCompile();
+			glAttachShader(pendingId, stage->getId());
+			pendingGenerations.push_back(stage->getGeneration());
+		}
+		for(auto& attribute : attributes){
+			glBindAttribLocation(pendingId, attribute.first, attribute.second.c_str());
+		}
+		glLinkProgram(pendingId);
+	}
+	//without KHR_parallel_shader_compile this waits for it right away
+	if(glMaxShaderCompilerThreadsKHR){
+		GLint done = GL_FALSE;
+		glGetProgramiv(pendingId, GL_COMPLETION_STATUS_KHR, &done);
+		if(done != GL_TRUE){
+			return false;
+		}
+	}
+	GLuint program = pendingId;
+	pendingId = 0;
+	//whatever happens, this version of the files has been tried
+	linkedGenerations = pendingGenerations;
+	bool compiled = true;
+	for(auto& stage : stages){
+		compiled = stage->compile() && compiled;
+	}
+	GLint linked = GL_FALSE;
+	if(compiled){
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		GLsizei length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::vector<GLchar> log(length + 1, '\0');
+		glGetProgramInfoLog(program, length, &length, log.data());
+		if(log[0] != '\0'){
+			std::cout << log.data() << std::endl;
+		}
+	}
+	if(linked != GL_TRUE){
+		glDeleteProgram(program);
+		printf("program %u: reload failed, keeping the old one\n", id);
+		return false;
+	}
+	GLuint old = id;
+	id = program;
+	glDeleteProgram(old);
+	reflect();
+	for(auto& blockBinding : blockBindings){
+		GLuint block = glGetUniformBlockIndex(id, blockBinding.first.c_str());
+		if(block != GL_INVALID_INDEX){
+			glUniformBlockBinding(id, block, blockBinding.second);
+		}
+	}
+	bind();
+	for(auto& uniform : uniforms){
+		const UniformSlot& slot = uniform.second;
+		if(slot.uploaded && slot.upload && slot.location >= 0){
+			slot.upload(slot.location, slot.value);
+		}
+	}
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - reloadStart).count();
+	printf("program %u: reloaded as %u in %.2f ms\n", old, id, milliseconds);
 	return true;
 }
 
+void Shader::reflect(){
+	//a reloaded program may have moved its uniforms around, the values stay for reload() to upload again
+	for(auto& uniform : uniforms){
+		uniform.second.location = -1;
+	}
+	attributeLocations.clear();
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<GLchar> name(maxLength + 1);
+	for(GLint i = 0; i < count; i++){
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(id, i, maxLength + 1, &length, &size, &type, name.data());
+		//members of uniform blocks have no location
+		GLint location = glGetUniformLocation(id, name.data());
+		if(location < 0){
+			continue;
+		}
+		std::string uniformName(name.data(), length);
+		//arrays are reported as name[0]
+		if(uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0){
+			uniformName.resize(uniformName.size() - 3);
+		}
+		auto found = uniforms.find(uniformName);
+		if(found == uniforms.end()){
+			found = uniforms.emplace(uniformName, UniformSlot()).first;
+			found->second.uploaded = false;
+			found->second.upload = nullptr;
+		}
+		found->second.location = location;
+		found->second.type = type;
+		found->second.size = size;
+	}
+	//the ones that were looked up by name before
+	for(auto& uniform : uniforms){
+		if(uniform.second.location < 0 && uniform.second.type == 0){
+			uniform.second.location = glGetUniformLocation(id, uniform.first.c_str());
+		}
+	}
+	glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	name.resize(maxLength + 1);
+	for(GLint i = 0; i < count; i++){
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveAttrib(id, i, maxLength + 1, &length, &size, &type, name.data());
+		std::string attributeName(name.data(), length);
+		attributeLocations[attributeName] = glGetAttribLocation(id, attributeName.c_str());
+	}
+}
+
+UniformSlot& Shader::findUniform(const std::string& name){
+	auto found = uniforms.find(name);
+	if(found != uniforms.end()){
+		return found->second;
+	}
+	UniformSlot& slot = uniforms[name];
+	slot.location = glGetUniformLocation(id, name.c_str());
+	slot.type = 0;
+	slot.size = 1;
+	slot.uploaded = false;
+	slot.upload = nullptr;
+	return slot;
+}
+
+static unsigned int skippedUniformUploads = 0;
+static unsigned int lastFrameSkippedUniformUploads = 0;
+
+void countSkippedUniformUpload(){
+	skippedUniformUploads++;
+}
+
+void endUniformUploadFrame(){
+	lastFrameSkippedUniformUploads = skippedUniformUploads;
+	skippedUniformUploads = 0;
+}
+
+unsigned int lastSkippedUniformUploads(){
+	return lastFrameSkippedUniformUploads;
+}
+
 std::unique_ptr<Shader> Shader::Create(std::string vertShaderPath, std::string fragShaderPath){
 	//first a vertex shader
 	auto vertexShader = ShaderStage::Create(GL_VERTEX_SHADER);
-	if(!vertexShader->compileFromFile(vertShaderPath)){
-		printf("compiling vertex shader failed :(");
+	if(!vertexShader->loadFromFile(vertShaderPath)){
+		printf("loading vertex shader failed :(");
 		return std::unique_ptr<Shader>();
 	}
 	//now a fragment shader
 	auto fragmentShader = ShaderStage::Create(GL_FRAGMENT_SHADER);
-	if(!fragmentShader->compileFromFile(fragShaderPath)){
-		printf("compiling fragment shader failed :(");
+	if(!fragmentShader->loadFromFile(fragShaderPath)){
+		printf("loading fragment shader failed :(");
 		return std::unique_ptr<Shader>();
 	}
 	//attach them to our program
@@ -103,4 +413,32 @@ std::unique_ptr<Shader> Shader::Create(std::string vertShaderPath, std::string f
 	shaderProgram->attach(std::move(vertexShader));
 	shaderProgram->attach(std::move(fragmentShader));
 	return shaderProgram;
-}
\ No newline at end of file
+}
+
+std::unique_ptr<Shader> Shader::Create(std::shared_ptr<ShaderStage> vertexShader, std::shared_ptr<ShaderStage> fragmentShader){
+	if(!vertexShader || !fragmentShader){
+		return std::unique_ptr<Shader>();
+	}
+	auto shaderProgram = Shader::Create();
+	shaderProgram->attach(vertexShader);
+	shaderProgram->attach(fragmentShader);
+	return shaderProgram;
+}
+
+std::shared_ptr<ShaderStage> ShaderPermutations::get(GLenum type, std::string filename, const ShaderDefines& defines){
+	//the defines are sorted by name, so the same set always makes the same key
+	std::string key = std::to_string(type) + " " + filename;
+	for(auto& define : defines){
+		key += " " + define.first + "=" + define.second;
+	}
+	auto found = stages.find(key);
+	if(found != stages.end()){
+		return found->second;
+	}
+	std::shared_ptr<ShaderStage> stage = ShaderStage::Create(type);
+	if(!stage->loadFromFile(filename, defines)){
+		return std::shared_ptr<ShaderStage>();
+	}
+	stages[key] = stage;
+	return stage;
+}
@@ -20,15 +20,38 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ***************************************************************************/
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <GL/glew.h>
+#include "gldispatch.h"
+#include "shaderpreprocessor.h"
+#include "glm/glm.hpp"
 
 class ShaderStage {
 private:
 	GLuint id;
-	ShaderStage(GLenum stage){
+	GLenum type;
+	//the file it came from, for messages
+	std::string name;
+	std::string source;
+	//the files in it by #line source string number, see shaderpreprocessor.h
+	std::vector<std::string> sources;
+	//for reloading, the defines it was loaded with and the versions of its files then (see filewatcher.h)
+	ShaderDefines defines;
+	std::vector<unsigned int> versions;
+	//goes up every time refresh() reloads the source
+	unsigned int generation;
+	bool started;
+	bool compiled;
+	void watchSources();
+	ShaderStage(GLenum stage) : type(stage), generation(0), started(false), compiled(false) {
 		id = glCreateShader(stage);
 	}
 public:
@@ -38,39 +61,229 @@ public:
 	~ShaderStage(){
 		glDeleteShader(id);
 	}
+	//keeps the source without compiling it, Shader::link compiles it unless the program comes from the binary cache
+	void load(std::string source, std::string name = "");
+	//runs the file through the preprocessor (see shaderpreprocessor.h)
+	//	returns false if it or one of its includes can't be read
+	bool loadFromFile(std::string filename, const ShaderDefines& defines = ShaderDefines());
+	//hands the loaded source to the driver without waiting for the result, once
+	void startCompile();
+	//compiles the loaded source if that hasn't been started yet and waits for the result
+	bool compile();
 	bool compile(std::string source);
-	bool compileFromFile(std::string filename);
+	bool compileFromFile(std::string filename, const ShaderDefines& defines = ShaderDefines());
+	//If the file or one of its includes changed on disk since it was loaded, loads it again into a new
+	//	shader object and starts compiling that. Programs already linked with the old one keep working,
+	//	Shader::reload links them again. Returns true if it reloaded.
+	bool refresh();
+	unsigned int getGeneration(){
+		return generation;
+	}
 	int getId(){
 		return id;
 	}
+	GLenum getType(){
+		return type;
+	}
+	const std::string& getSource(){
+		return source;
+	}
+};
+
+//One uniform of a linked program, from the reflection Shader does at link time
+struct UniformSlot {
+	//-1 if the program has no such uniform
+	GLint location;
+	//GL_FLOAT_VEC3 and so on, 0 if it was looked up by name instead of found by reflection
+	GLenum type;
+	//array length
+	GLint size;
+	//the last value a Uniform handle uploaded, valid once uploaded is set
+	bool uploaded;
+	GLfloat value[16];
+	//uploads value as the type of the handle that set it, to give a reloaded program the same values
+	void (*upload)(GLint location, const GLfloat* value);
+};
+
+inline void uploadUniform(GLint location, GLint value){
+	glUniform1i(location, value);
+}
+inline void uploadUniform(GLint location, GLfloat value){
+	glUniform1f(location, value);
+}
+inline void uploadUniform(GLint location, const glm::vec3& value){
+	glUniform3fv(location, 1, &value[0]);
+}
+inline void uploadUniform(GLint location, const glm::vec4& value){
+	glUniform4fv(location, 1, &value[0]);
+}
+inline void uploadUniform(GLint location, const glm::mat4& value){
+	glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+//glUniform* calls the Uniform handles have skipped, swapBuffers closes out each frame
+void countSkippedUniformUpload();
+void endUniformUploadFrame();
+unsigned int lastSkippedUniformUploads();
+
+//A handle to one uniform of a program that only calls glUniform* when the value differs from the last one uploaded
+//	Handles to the same uniform share the program's copy of the value, but glUniform* calls made around them
+//	(Material::apply for example) leave it stale, so a uniform should be set one way or the other.
+//	Like glUniform* the program has to be bound when set is called.
+template<class T>
+class Uniform {
+private:
+	UniformSlot* slot;
+	static_assert(sizeof(T) <= sizeof(UniformSlot::value), "uniform type too large");
+	static void uploadValue(GLint location, const GLfloat* value){
+		T v;
+		memcpy(static_cast<void*>(&v), value, sizeof(T));
+		uploadUniform(location, v);
+	}
+public:
+	Uniform() : slot(nullptr) {}
+	explicit Uniform(UniformSlot* slot) : slot(slot) {}
+	//false if the program has no such uniform, setting it then does nothing
+	bool isValid() const {
+		return slot && slot->location >= 0;
+	}
+	void set(const T& value){
+		if(!isValid()){
+			return;
+		}
+		if(slot->uploaded && memcmp(slot->value, &value, sizeof(T)) == 0){
+			countSkippedUniformUpload();
+			return;
+		}
+		memcpy(slot->value, &value, sizeof(T));
+		slot->uploaded = true;
+		slot->upload = &uploadValue;
+		uploadUniform(slot->location, value);
+	}
 };
 
 class Shader {
 protected:
 	GLuint id;
-	std::vector<std::unique_ptr<ShaderStage>> stages;
-	Shader(){
+	//shared so that one compiled stage can go into several programs, see ShaderPermutations
+	std::vector<std::shared_ptr<ShaderStage>> stages;
+	//part of the program binary cache key, they are baked into the binary
+	std::vector<std::pair<int,std::string>> attributes;
+	uint64_t binaryKey();
+	//state of a link started with linkAsync
+	bool linking;
+	bool fromCache;
+	uint64_t key;
+	std::chrono::high_resolution_clock::time_point linkStart;
+	//filled in from glGetActiveUniform/glGetActiveAttrib once linked
+	//	The slots are never erased, so the pointers Uniform handles keep stay valid across a relink.
+	std::unordered_map<std::string, UniformSlot> uniforms;
+	std::unordered_map<std::string, GLint> attributeLocations;
+	void reflect();
+	UniformSlot& findUniform(const std::string& name);
+	//what bindUniformBlock set, it is part of the program and has to be set again on a reloaded one
+	std::vector<std::pair<std::string,GLuint>> blockBindings;
+	//the generation of each stage the program was linked with, and the program reload() is linking
+	std::vector<unsigned int> linkedGenerations;
+	std::vector<unsigned int> pendingGenerations;
+	GLuint pendingId;
+	std::chrono::high_resolution_clock::time_point reloadStart;
+	Shader() : linking(false), fromCache(false), key(0), pendingId(0) {
 		id = glCreateProgram();
 	}
 public:
 	~Shader(){
 		glDeleteProgram(id);
+		if(pendingId){
+			glDeleteProgram(pendingId);
+		}
 	}
 	static std::unique_ptr<Shader> Create(){
 		return std::unique_ptr<Shader>(new Shader());
 	}
+	//only reads the files, compile errors show up in link()
 	static std::unique_ptr<Shader> Create(std::string vertShaderPath, std::string fragShaderPath);
-	void attach(std::unique_ptr<ShaderStage> stage){
+	//empty if either stage is missing
+	static std::unique_ptr<Shader> Create(std::shared_ptr<ShaderStage> vertexShader, std::shared_ptr<ShaderStage> fragmentShader);
+	void attach(std::shared_ptr<ShaderStage> stage){
 		stages.push_back(std::move(stage));
 	}
 	void bindAttrib(int index,std::string name){
 		glBindAttribLocation(id,index, name.c_str());
+		attributes.push_back(std::make_pair(index,name));
+	}
+	//compiles every stage and links them, or loads the program from the binary cache (see programcache.h)
+	//	prints how long either took
+	bool link(){
+		linkAsync();
+		return finishLink();
+	}
+	//Starts compiling and linking without asking the driver how it went, which would make it finish first
+	//	With KHR_parallel_shader_compile the driver works on every started program at once in the background,
+	//	so start all of them, do other setup and only then finish each one.
+	void linkAsync();
+	//polls whether linkAsync's work is done, never blocks
+	//	Without KHR_parallel_shader_compile there is no way to tell and it is always true.
+	bool isReady();
+	//waits for linkAsync's work and reports it like link() does
+	bool finishLink();
+	//attaches the named uniform block to a binding point, after link()
+	//	returns false if the program doesn't use that block
+	bool bindUniformBlock(std::string name, GLuint binding){
+		GLuint block = glGetUniformBlockIndex(id, name.c_str());
+		if(block == GL_INVALID_INDEX){
+			return false;
+		}
+		glUniformBlockBinding(id, block, binding);
+		for(auto& blockBinding : blockBindings){
+			if(blockBinding.first == name){
+				blockBinding.second = binding;
+				return true;
+			}
+		}
+		blockBindings.push_back(std::make_pair(name, binding));
+		return true;
+	}
+	//Hot reload, call once a frame: links the program again when a stage's file changed (see ShaderStage::refresh)
+	//	The new program is built next to the current one, in the background with KHR_parallel_shader_compile,
+	//	and takes its place under the same Shader once it has linked, with the same attributes, uniform block
+	//	bindings and Uniform handle values. If it doesn't compile or link the current one stays.
+	//	Locations looked up before (Material values, for example) may be wrong for the new program.
+	//	Returns true on the call where the new program took over, it is then bound.
+	bool reload();
+	//location of the named uniform, from the table reflection built at link time
+	//	Names not in it (array elements, or any name with the recording backend, which reports no active uniforms)
+	//	are asked for once with glGetUniformLocation and remembered. -1 if the program has no such uniform.
+	GLint getUniformLocation(const std::string& name){
+		return findUniform(name).location;
+	}
+	//location of the named vertex attribute, -1 if the program doesn't use it
+	GLint getAttribLocation(const std::string& name){
+		auto found = attributeLocations.find(name);
+		return found == attributeLocations.end() ? -1 : found->second;
+	}
+	//a handle that only uploads when the value changes, valid as long as the program
+	template<class T>
+	Uniform<T> uniform(const std::string& name){
+		return Uniform<T>(&findUniform(name));
 	}
-	bool link();
 	void bind(){
 		glUseProgram(id);
 	}
 	int getId(){
 		return id;
 	}
-};
\ No newline at end of file
+};
+//Hands out one stage per (type, file, defines), so every program using a variant shares one compile of it
+//	Lets a material variant be specialized with a define instead of branching on a uniform in every fragment,
+//	without paying to compile the stages it has in common with the other variants again.
+class ShaderPermutations {
+private:
+	std::map<std::string, std::shared_ptr<ShaderStage>> stages;
+public:
+	//empty if the file can't be read, the stage is only compiled when a program using it is linked
+	std::shared_ptr<ShaderStage> get(GLenum type, std::string filename, const ShaderDefines& defines = ShaderDefines());
+	size_t size(){
+		return stages.size();
+	}
+};
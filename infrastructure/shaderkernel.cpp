@@ -0,0 +1,1402 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "shaderkernel.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace {
+const int L = ShaderKernel::Lanes;
+
+struct Token {
+	enum Kind { Identifier, Number, Symbol, End };
+	Kind kind;
+	std::string text;
+	float number;
+	//#line source string and line, for messages
+	int source;
+	int line;
+};
+
+//rows x columns: float is 1x1, vec3 3x1, mat4 4x4 and void 0x0
+struct Type {
+	int rows;
+	int columns;
+	int components() const {
+		return rows * columns;
+	}
+	bool isScalar() const {
+		return rows == 1 && columns == 1;
+	}
+	bool isMatrix() const {
+		return columns > 1;
+	}
+	bool operator==(const Type& other) const {
+		return rows == other.rows && columns == other.columns;
+	}
+	bool operator!=(const Type& other) const {
+		return !(*this == other);
+	}
+};
+
+const Type floatType = {1, 1};
+
+bool findType(const std::string& name, Type& type){
+	static const std::unordered_map<std::string, Type> types = {
+		{"void", {0, 0}}, {"float", {1, 1}}, {"int", {1, 1}}, {"uint", {1, 1}}, {"bool", {1, 1}},
+		{"vec2", {2, 1}}, {"vec3", {3, 1}}, {"vec4", {4, 1}},
+		{"ivec2", {2, 1}}, {"ivec3", {3, 1}}, {"ivec4", {4, 1}},
+		{"uvec2", {2, 1}}, {"uvec3", {3, 1}}, {"uvec4", {4, 1}},
+		{"bvec2", {2, 1}}, {"bvec3", {3, 1}}, {"bvec4", {4, 1}},
+		{"mat2", {2, 2}}, {"mat3", {3, 3}}, {"mat4", {4, 4}}
+	};
+	auto found = types.find(name);
+	if(found == types.end()){
+		return false;
+	}
+	type = found->second;
+	return true;
+}
+
+bool isQualifier(const std::string& word){
+	return word == "highp" || word == "mediump" || word == "lowp" || word == "flat" || word == "smooth"
+		|| word == "centroid" || word == "invariant" || word == "precise";
+}
+
+//a register, plus which components of which variable it is if it can be assigned to
+struct Value {
+	int offset;
+	Type type;
+	int variable;
+	std::vector<int> components;
+};
+
+//blanks out comments, keeping the newlines so line numbers stay right
+std::string stripComments(const std::string& source){
+	std::string out = source;
+	for(size_t i = 0; i + 1 < out.size(); i++){
+		if(out[i] == '/' && out[i + 1] == '/'){
+			while(i < out.size() && out[i] != '\n'){
+				out[i++] = ' ';
+			}
+		} else if(out[i] == '/' && out[i + 1] == '*'){
+			size_t end = out.find("*/", i + 2);
+			end = end == std::string::npos ? out.size() : end + 2;
+			for(; i < end; i++){
+				if(out[i] != '\n'){
+					out[i] = ' ';
+				}
+			}
+			i--;
+		}
+	}
+	return out;
+}
+}
+
+class ShaderKernelCompiler {
+private:
+	struct Function {
+		Type returnType;
+		std::vector<std::pair<Type, std::string>> parameters;
+		size_t body;
+	};
+	//the function being inlined
+	struct Call {
+		Value result;
+		bool returned;
+	};
+	ShaderKernel& kernel;
+	std::string name;
+	bool failed;
+	std::vector<Token> tokens;
+	size_t position;
+	std::unordered_map<std::string, std::vector<Token>> macros;
+	std::unordered_map<std::string, std::vector<Function>> functions;
+	//scopes[0] holds the globals, a function only sees those and its own scopes from scopeFloor on
+	std::vector<std::unordered_map<std::string, Value>> scopes;
+	size_t scopeFloor;
+	std::vector<Call> calls;
+	std::unordered_map<uint32_t, int> constants;
+
+	//messages
+	bool error(const std::string& message){
+		if(!failed){
+			const Token& at = tokens.empty() ? Token() : tokens[std::min(position, tokens.size() - 1)];
+			printf("%s:%d:%d: %s\n", name.c_str(), at.source, at.line, message.c_str());
+		}
+		failed = true;
+		return false;
+	}
+	Value dummy(){
+		return Value{constant(0.f), floatType, -1, {}};
+	}
+
+	//tokens
+	void addTokens(const std::string& text, int source, int line, std::vector<Token>& out, bool expand, int depth);
+	bool tokenize(const std::string& source);
+	const Token& peek(size_t ahead = 0){
+		return tokens[std::min(position + ahead, tokens.size() - 1)];
+	}
+	bool is(const char* text){
+		return peek().kind != Token::Number && peek().text == text;
+	}
+	bool accept(const char* text){
+		if(!is(text)){
+			return false;
+		}
+		position++;
+		return true;
+	}
+	void expect(const char* text){
+		if(!accept(text)){
+			error(std::string("expected '") + text + "' but found '" + peek().text + "'");
+		}
+	}
+	std::string identifier(){
+		if(peek().kind != Token::Identifier){
+			error("expected a name but found '" + peek().text + "'");
+			return std::string();
+		}
+		return tokens[position++].text;
+	}
+	bool peekType(){
+		Type type;
+		return peek().kind == Token::Identifier && findType(peek().text, type);
+	}
+	Type type(){
+		Type type = floatType;
+		if(!findType(peek().text, type)){
+			error("expected a type but found '" + peek().text + "'");
+		}
+		position++;
+		return type;
+	}
+	void skipQualifiers(){
+		while(peek().kind == Token::Identifier && isQualifier(peek().text)){
+			position++;
+		}
+	}
+
+	//registers
+	int allocate(const Type& type){
+		int offset = int(kernel.memory.size());
+		kernel.memory.resize(kernel.memory.size() + std::max(type.components(), 1) * L, 0.f);
+		return offset;
+	}
+	Value temporary(const Type& type){
+		return Value{allocate(type), type, -1, {}};
+	}
+	Value variable(const Type& type){
+		Value value = temporary(type);
+		value.variable = value.offset;
+		for(int i = 0; i < type.components(); i++){
+			value.components.push_back(i);
+		}
+		return value;
+	}
+	int constant(float value){
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		auto found = constants.find(bits);
+		if(found != constants.end()){
+			return found->second;
+		}
+		int offset = allocate(floatType);
+		for(int i = 0; i < L; i++){
+			kernel.memory[offset + i] = value;
+		}
+		constants[bits] = offset;
+		return offset;
+	}
+	Value* lookup(const std::string& name){
+		for(size_t i = scopes.size(); i-- > scopeFloor;){
+			auto found = scopes[i].find(name);
+			if(found != scopes[i].end()){
+				return &found->second;
+			}
+		}
+		auto found = scopes[0].find(name);
+		return found == scopes[0].end() ? nullptr : &found->second;
+	}
+	Value declareSlot(std::unordered_map<std::string, ShaderKernel::Slot>& slots, const std::string& name, const Type& type){
+		Value value = variable(type);
+		slots[name] = ShaderKernel::Slot{value.offset, type.components()};
+		scopes[0][name] = value;
+		return value;
+	}
+
+	//operations
+	void copy(const std::vector<std::pair<int, int>>& copies){
+		kernel.program.push_back([copies](float* m){
+			for(auto& c : copies){
+				memcpy(m + c.first, m + c.second, L * sizeof(float));
+			}
+		});
+	}
+	Value gather(const std::vector<int>& sources, const Type& type){
+		Value result = temporary(type);
+		std::vector<std::pair<int, int>> copies;
+		for(size_t i = 0; i < sources.size(); i++){
+			copies.push_back(std::make_pair(result.offset + int(i) * L, sources[i]));
+		}
+		copy(copies);
+		return result;
+	}
+	void assign(const Value& target, const Value& value){
+		if(int(target.components.size()) != value.type.components()){
+			error("assigning a value of the wrong size");
+			return;
+		}
+		std::vector<std::pair<int, int>> copies;
+		for(size_t i = 0; i < target.components.size(); i++){
+			copies.push_back(std::make_pair(target.variable + target.components[i] * L, value.offset + int(i) * L));
+		}
+		copy(copies);
+	}
+	template<class F>
+	Value map(const Value& a, F f){
+		Value result = temporary(a.type);
+		int count = a.type.components(), from = a.offset, to = result.offset;
+		kernel.program.push_back([=](float* m){
+			for(int c = 0; c < count; c++){
+				const float* x = m + from + c * L;
+				float* d = m + to + c * L;
+				for(int i = 0; i < L; i++){
+					d[i] = f(x[i]);
+				}
+			}
+		});
+		return result;
+	}
+	//scalars are used for every component of the other operand
+	template<class F>
+	Value combine(const Value& a, const Value& b, F f){
+		if(a.type != b.type && !a.type.isScalar() && !b.type.isScalar()){
+			error("operands have different types");
+			return dummy();
+		}
+		Type type = a.type.isScalar() ? b.type : a.type;
+		Value result = temporary(type);
+		int count = type.components(), ao = a.offset, bo = b.offset, to = result.offset;
+		int as = a.type.isScalar() ? 0 : L, bs = b.type.isScalar() ? 0 : L;
+		kernel.program.push_back([=](float* m){
+			for(int c = 0; c < count; c++){
+				const float* x = m + ao + c * as;
+				const float* y = m + bo + c * bs;
+				float* d = m + to + c * L;
+				for(int i = 0; i < L; i++){
+					d[i] = f(x[i], y[i]);
+				}
+			}
+		});
+		return result;
+	}
+	template<class F>
+	Value combine(const Value& a, const Value& b, const Value& c, F f){
+		Type type = !a.type.isScalar() ? a.type : !b.type.isScalar() ? b.type : c.type;
+		if((!a.type.isScalar() && a.type != type) || (!b.type.isScalar() && b.type != type) || (!c.type.isScalar() && c.type != type)){
+			error("operands have different types");
+			return dummy();
+		}
+		Value result = temporary(type);
+		int count = type.components(), ao = a.offset, bo = b.offset, co = c.offset, to = result.offset;
+		int as = a.type.isScalar() ? 0 : L, bs = b.type.isScalar() ? 0 : L, cs = c.type.isScalar() ? 0 : L;
+		kernel.program.push_back([=](float* m){
+			for(int k = 0; k < count; k++){
+				const float* x = m + ao + k * as;
+				const float* y = m + bo + k * bs;
+				const float* z = m + co + k * cs;
+				float* d = m + to + k * L;
+				for(int i = 0; i < L; i++){
+					d[i] = f(x[i], y[i], z[i]);
+				}
+			}
+		});
+		return result;
+	}
+	Value dot(const Value& a, const Value& b){
+		if(a.type != b.type || a.type.isMatrix()){
+			error("dot needs two vectors of the same size");
+			return dummy();
+		}
+		Value result = temporary(floatType);
+		int count = a.type.components(), ao = a.offset, bo = b.offset, to = result.offset;
+		kernel.program.push_back([=](float* m){
+			float* d = m + to;
+			for(int i = 0; i < L; i++){
+				d[i] = 0.f;
+			}
+			for(int c = 0; c < count; c++){
+				const float* x = m + ao + c * L;
+				const float* y = m + bo + c * L;
+				for(int i = 0; i < L; i++){
+					d[i] += x[i] * y[i];
+				}
+			}
+		});
+		return result;
+	}
+	//matrix * vector, vector * matrix and matrix * matrix
+	Value product(const Value& a, const Value& b){
+		int rows = a.type.isMatrix() ? a.type.rows : 1;
+		int inner = a.type.isMatrix() ? a.type.columns : a.type.components();
+		int innerB = b.type.isMatrix() ? b.type.rows : b.type.components();
+		int columns = b.type.isMatrix() ? b.type.columns : 1;
+		if(inner != innerB){
+			error("matrix sizes don't match");
+			return dummy();
+		}
+		Type type = rows == 1 ? Type{columns, 1} : columns == 1 ? Type{rows, 1} : Type{rows, columns};
+		Value result = temporary(type);
+		int ao = a.offset, bo = b.offset, to = result.offset;
+		kernel.program.push_back([=](float* m){
+			for(int j = 0; j < columns; j++){
+				for(int r = 0; r < rows; r++){
+					float* d = m + to + (j * rows + r) * L;
+					for(int i = 0; i < L; i++){
+						d[i] = 0.f;
+					}
+					for(int k = 0; k < inner; k++){
+						const float* x = m + ao + (k * rows + r) * L;
+						const float* y = m + bo + (j * inner + k) * L;
+						for(int i = 0; i < L; i++){
+							d[i] += x[i] * y[i];
+						}
+					}
+				}
+			}
+		});
+		return result;
+	}
+	Value arithmetic(char op, const Value& a, const Value& b){
+		if(op == '*' && (a.type.isMatrix() || b.type.isMatrix()) && !a.type.isScalar() && !b.type.isScalar()){
+			return product(a, b);
+		}
+		switch(op){
+		case '+': return combine(a, b, [](float x, float y){ return x + y; });
+		case '-': return combine(a, b, [](float x, float y){ return x - y; });
+		case '*': return combine(a, b, [](float x, float y){ return x * y; });
+		default: return combine(a, b, [](float x, float y){ return x / y; });
+		}
+	}
+	//per lane through glm, for the matrix functions that don't split into components
+	template<int N, class F>
+	Value perMatrix(const Value& a, const Type& resultType, F f){
+		Value result = temporary(resultType);
+		int from = a.offset, to = result.offset, count = resultType.components();
+		kernel.program.push_back([=](float* m){
+			for(int i = 0; i < L; i++){
+				float in[N * N], out[16];
+				for(int c = 0; c < N * N; c++){
+					in[c] = m[from + c * L + i];
+				}
+				f(in, out);
+				for(int c = 0; c < count; c++){
+					m[to + c * L + i] = out[c];
+				}
+			}
+		});
+		return result;
+	}
+	Value matrixFunction(const std::string& function, const Value& a);
+	Value builtin(const std::string& function, const std::vector<Value>& args);
+	Value construct(const std::string& typeName, const Type& type, const std::vector<Value>& args);
+	Value call(const std::string& function, const std::vector<Value>& args);
+	Value swizzle(const Value& value, const std::string& fields);
+	Value index(const Value& value, int i);
+
+	//grammar
+	std::vector<Value> arguments();
+	Value primary();
+	Value postfix();
+	Value unary();
+	Value multiplicative();
+	Value additive();
+	Value relational();
+	Value equality();
+	Value logicalAnd();
+	Value logicalOr();
+	Value ternary();
+	Value assignment();
+	void declaration();
+	void statement();
+	void block();
+	void function(const Type& returnType, const std::string& name);
+	void topLevel();
+public:
+	ShaderKernelCompiler(ShaderKernel& kernel, const std::string& name) : kernel(kernel), name(name), failed(false), position(0), scopeFloor(0) {}
+	bool compile(const std::string& source);
+};
+
+void ShaderKernelCompiler::addTokens(const std::string& text, int source, int line, std::vector<Token>& out, bool expand, int depth){
+	static const char* pairs[] = {"+=", "-=", "*=", "/=", "==", "!=", "<=", ">=", "&&", "||", "++", "--"};
+	size_t i = 0;
+	while(i < text.size()){
+		char c = text[i];
+		Token token = {Token::Symbol, std::string(), 0.f, source, line};
+		if(isspace((unsigned char)c)){
+			i++;
+			continue;
+		} else if(isalpha((unsigned char)c) || c == '_'){
+			size_t end = i;
+			while(end < text.size() && (isalnum((unsigned char)text[end]) || text[end] == '_')){
+				end++;
+			}
+			token.kind = Token::Identifier;
+			token.text = text.substr(i, end - i);
+			i = end;
+			auto macro = macros.find(token.text);
+			if(expand && macro != macros.end()){
+				if(depth > 16){
+					error("macro " + token.text + " expands into itself");
+					return;
+				}
+				for(const Token& part : macro->second){
+					addTokens(part.text, source, line, out, true, depth + 1);
+				}
+				continue;
+			}
+		} else if(isdigit((unsigned char)c) || (c == '.' && i + 1 < text.size() && isdigit((unsigned char)text[i + 1]))){
+			char* end;
+			token.kind = Token::Number;
+			token.number = strtof(text.c_str() + i, &end);
+			size_t next = end - text.c_str();
+			while(next < text.size() && (text[next] == 'f' || text[next] == 'F' || text[next] == 'u' || text[next] == 'U')){
+				next++;
+			}
+			token.text = text.substr(i, next - i);
+			i = next;
+		} else {
+			token.text = std::string(1, c);
+			for(const char* pair : pairs){
+				if(text.compare(i, 2, pair) == 0){
+					token.text = pair;
+				}
+			}
+			i += token.text.size();
+		}
+		out.push_back(token);
+	}
+}
+
+bool ShaderKernelCompiler::tokenize(const std::string& text){
+	struct Condition {
+		bool active;
+		bool parentActive;
+		bool taken;
+	};
+	std::vector<Condition> conditions;
+	macros["GL_ES"] = std::vector<Token>(1, Token{Token::Number, "1", 1.f, 0, 0});
+	macros["__VERSION__"] = std::vector<Token>(1, Token{Token::Number, "300", 300.f, 0, 0});
+	std::string source = stripComments(text);
+	int file = 0, line = 0;
+	size_t start = 0;
+	while(!failed && start < source.size()){
+		size_t end = source.find('\n', start);
+		if(end == std::string::npos){
+			end = source.size();
+		}
+		std::string current = source.substr(start, end - start);
+		start = end + 1;
+		line++;
+		bool active = conditions.empty() || conditions.back().active;
+		size_t first = current.find_first_not_of(" \t\r");
+		if(first == std::string::npos){
+			continue;
+		}
+		if(current[first] != '#'){
+			if(active){
+				addTokens(current, file, line, tokens, true, 0);
+			}
+			continue;
+		}
+		//errors point at the directive
+		tokens.push_back(Token{Token::End, current, 0.f, file, line});
+		position = tokens.size() - 1;
+		std::istringstream words(current.substr(first + 1));
+		std::string directive, word;
+		words >> directive;
+		if(directive == "ifdef" || directive == "ifndef"){
+			words >> word;
+			bool value = (macros.count(word) != 0) == (directive == "ifdef");
+			conditions.push_back(Condition{active && value, active, value});
+		} else if(directive == "if"){
+			std::vector<Token> expression;
+			std::string rest;
+			std::getline(words, rest);
+			addTokens(rest, file, line, expression, false, 0);
+			bool value = false;
+			if(expression.size() == 1 && expression[0].kind == Token::Number){
+				value = expression[0].number != 0.f;
+			} else if(expression.size() == 4 && expression[0].text == "defined" && expression[1].text == "(" && expression[3].text == ")"){
+				value = macros.count(expression[2].text) != 0;
+			} else if(expression.size() == 2 && expression[0].text == "defined"){
+				value = macros.count(expression[1].text) != 0;
+			} else if(expression.size() == 1 && expression[0].kind == Token::Identifier){
+				std::vector<Token> expanded;
+				addTokens(expression[0].text, file, line, expanded, true, 0);
+				value = expanded.size() == 1 && expanded[0].kind == Token::Number && expanded[0].number != 0.f;
+			} else {
+				error("only #if with a number or defined() is supported");
+			}
+			conditions.push_back(Condition{active && value, active, value});
+		} else if(directive == "else"){
+			if(conditions.empty()){
+				error("#else without #if");
+				break;
+			}
+			Condition& condition = conditions.back();
+			condition.active = condition.parentActive && !condition.taken;
+			condition.taken = true;
+		} else if(directive == "endif"){
+			if(conditions.empty()){
+				error("#endif without #if");
+				break;
+			}
+			conditions.pop_back();
+		} else if(!active || directive == "version" || directive == "extension" || directive == "pragma"){
+		} else if(directive == "define"){
+			words >> word;
+			if(word.find('(') != std::string::npos){
+				error("macros with parameters aren't supported");
+				break;
+			}
+			std::string rest;
+			std::getline(words, rest);
+			std::vector<Token>& body = macros[word];
+			body.clear();
+			addTokens(rest, file, line, body, false, 0);
+		} else if(directive == "undef"){
+			words >> word;
+			macros.erase(word);
+		} else if(directive == "line"){
+			words >> line;
+			line--;
+			words >> file;
+		} else {
+			error("#" + directive + " isn't supported");
+		}
+		tokens.pop_back();
+	}
+	if(!failed && !conditions.empty()){
+		error("#if without #endif");
+	}
+	tokens.push_back(Token{Token::End, "end of file", 0.f, file, line});
+	position = 0;
+	return !failed;
+}
+
+Value ShaderKernelCompiler::matrixFunction(const std::string& function, const Value& a){
+	int n = a.type.rows;
+	if(!a.type.isMatrix() || a.type.columns != n){
+		error(function + " needs a square matrix");
+		return dummy();
+	}
+	if(function == "transpose"){
+		std::vector<int> sources;
+		for(int column = 0; column < n; column++){
+			for(int row = 0; row < n; row++){
+				sources.push_back(a.offset + (row * n + column) * L);
+			}
+		}
+		return gather(sources, a.type);
+	}
+	bool determinant = function == "determinant";
+	Type type = determinant ? floatType : a.type;
+	switch(n){
+	case 2:
+		return perMatrix<2>(a, type, [determinant](const float* in, float* out){
+			glm::mat2 matrix = glm::make_mat2(in);
+			if(determinant){
+				out[0] = glm::determinant(matrix);
+			} else {
+				memcpy(out, glm::value_ptr(glm::inverse(matrix)), sizeof(matrix));
+			}
+		});
+	case 3:
+		return perMatrix<3>(a, type, [determinant](const float* in, float* out){
+			glm::mat3 matrix = glm::make_mat3(in);
+			if(determinant){
+				out[0] = glm::determinant(matrix);
+			} else {
+				memcpy(out, glm::value_ptr(glm::inverse(matrix)), sizeof(matrix));
+			}
+		});
+	default:
+		return perMatrix<4>(a, type, [determinant](const float* in, float* out){
+			glm::mat4 matrix = glm::make_mat4(in);
+			if(determinant){
+				out[0] = glm::determinant(matrix);
+			} else {
+				memcpy(out, glm::value_ptr(glm::inverse(matrix)), sizeof(matrix));
+			}
+		});
+	}
+}
+
+//builtins
+Value ShaderKernelCompiler::builtin(const std::string& function, const std::vector<Value>& args){
+	typedef float (*Unary)(float);
+	static const std::unordered_map<std::string, Unary> unary = {
+		{"radians", [](float x){ return x * 0.01745329252f; }},
+		{"degrees", [](float x){ return x * 57.295779513f; }},
+		{"sin", [](float x){ return std::sin(x); }},
+		{"cos", [](float x){ return std::cos(x); }},
+		{"tan", [](float x){ return std::tan(x); }},
+		{"asin", [](float x){ return std::asin(x); }},
+		{"acos", [](float x){ return std::acos(x); }},
+		{"exp", [](float x){ return std::exp(x); }},
+		{"log", [](float x){ return std::log(x); }},
+		{"exp2", [](float x){ return std::exp2(x); }},
+		{"log2", [](float x){ return std::log2(x); }},
+		{"sqrt", [](float x){ return std::sqrt(x); }},
+		{"inversesqrt", [](float x){ return 1.f / std::sqrt(x); }},
+		{"abs", [](float x){ return std::fabs(x); }},
+		{"sign", [](float x){ return x > 0.f ? 1.f : x < 0.f ? -1.f : 0.f; }},
+		{"floor", [](float x){ return std::floor(x); }},
+		{"ceil", [](float x){ return std::ceil(x); }},
+		{"trunc", [](float x){ return std::trunc(x); }},
+		{"round", [](float x){ return std::round(x); }},
+		{"fract", [](float x){ return x - std::floor(x); }}
+	};
+	size_t count = args.size();
+	auto found = unary.find(function);
+	if(found != unary.end() && count == 1){
+		if(args[0].type.isMatrix()){
+			error(function + " doesn't take a matrix");
+			return dummy();
+		}
+		return map(args[0], found->second);
+	}
+	if(count == 1 && (function == "transpose" || function == "inverse" || function == "determinant")){
+		return matrixFunction(function, args[0]);
+	}
+	if(count == 1 && function == "length"){
+		return map(dot(args[0], args[0]), [](float x){ return std::sqrt(x); });
+	}
+	if(count == 1 && function == "normalize"){
+		return arithmetic('*', args[0], map(dot(args[0], args[0]), [](float x){ return 1.f / std::sqrt(x); }));
+	}
+	if(count == 2 && function == "dot"){
+		return dot(args[0], args[1]);
+	}
+	if(count == 2 && function == "distance"){
+		Value difference = arithmetic('-', args[0], args[1]);
+		return map(dot(difference, difference), [](float x){ return std::sqrt(x); });
+	}
+	if(count == 2 && function == "reflect"){
+		Value twice = arithmetic('*', Value{constant(2.f), floatType, -1, {}}, dot(args[1], args[0]));
+		return arithmetic('-', args[0], arithmetic('*', twice, args[1]));
+	}
+	if(count == 2 && function == "cross"){
+		if(args[0].type != Type{3, 1} || args[1].type != Type{3, 1}){
+			error("cross needs two vec3");
+			return dummy();
+		}
+		Value result = temporary(args[0].type);
+		int ao = args[0].offset, bo = args[1].offset, to = result.offset;
+		kernel.program.push_back([=](float* m){
+			for(int c = 0; c < 3; c++){
+				const float* a1 = m + ao + ((c + 1) % 3) * L;
+				const float* a2 = m + ao + ((c + 2) % 3) * L;
+				const float* b1 = m + bo + ((c + 1) % 3) * L;
+				const float* b2 = m + bo + ((c + 2) % 3) * L;
+				float* d = m + to + c * L;
+				for(int i = 0; i < L; i++){
+					d[i] = a1[i] * b2[i] - a2[i] * b1[i];
+				}
+			}
+		});
+		return result;
+	}
+	if(count == 2){
+		if(function == "pow"){
+			return combine(args[0], args[1], [](float x, float y){ return std::pow(x, y); });
+		} else if(function == "min"){
+			return combine(args[0], args[1], [](float x, float y){ return y < x ? y : x; });
+		} else if(function == "max"){
+			return combine(args[0], args[1], [](float x, float y){ return x < y ? y : x; });
+		} else if(function == "mod"){
+			return combine(args[0], args[1], [](float x, float y){ return x - y * std::floor(x / y); });
+		} else if(function == "step"){
+			return combine(args[0], args[1], [](float edge, float x){ return x < edge ? 0.f : 1.f; });
+		} else if(function == "atan"){
+			return combine(args[0], args[1], [](float y, float x){ return std::atan2(y, x); });
+		}
+	}
+	if(count == 1 && function == "atan"){
+		return map(args[0], [](float x){ return std::atan(x); });
+	}
+	if(count == 3){
+		if(function == "mix"){
+			return combine(args[0], args[1], args[2], [](float x, float y, float a){ return x + (y - x) * a; });
+		} else if(function == "clamp"){
+			return combine(args[0], args[1], args[2], [](float x, float low, float high){ return std::min(std::max(x, low), high); });
+		} else if(function == "smoothstep"){
+			return combine(args[0], args[1], args[2], [](float edge0, float edge1, float x){
+				float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.f), 1.f);
+				return t * t * (3.f - 2.f * t);
+			});
+		}
+	}
+	error("unknown function " + function + " with " + std::to_string(count) + " arguments");
+	return dummy();
+}
+
+Value ShaderKernelCompiler::construct(const std::string& typeName, const Type& type, const std::vector<Value>& args){
+	if(args.empty() || type.components() == 0){
+		error("can't construct " + typeName + " from nothing");
+		return dummy();
+	}
+	const Value& first = args[0];
+	if(type.isScalar() && args.size() == 1){
+		if(typeName == "int" || typeName == "uint"){
+			return map(Value{first.offset, floatType, -1, {}}, [](float x){ return std::trunc(x); });
+		} else if(typeName == "bool"){
+			return map(Value{first.offset, floatType, -1, {}}, [](float x){ return x != 0.f ? 1.f : 0.f; });
+		}
+		return Value{first.offset, floatType, -1, {}};
+	}
+	std::vector<int> sources;
+	if(args.size() == 1 && first.type.isScalar()){
+		for(int column = 0; column < type.columns; column++){
+			for(int row = 0; row < type.rows; row++){
+				sources.push_back(!type.isMatrix() || row == column ? first.offset : constant(0.f));
+			}
+		}
+	} else if(args.size() == 1 && first.type.isMatrix() && type.isMatrix()){
+		for(int column = 0; column < type.columns; column++){
+			for(int row = 0; row < type.rows; row++){
+				if(column < first.type.columns && row < first.type.rows){
+					sources.push_back(first.offset + (column * first.type.rows + row) * L);
+				} else {
+					sources.push_back(constant(row == column ? 1.f : 0.f));
+				}
+			}
+		}
+	} else {
+		for(const Value& arg : args){
+			for(int c = 0; c < arg.type.components(); c++){
+				sources.push_back(arg.offset + c * L);
+			}
+		}
+		if(int(sources.size()) < type.components()){
+			error("not enough values to construct " + typeName);
+			return dummy();
+		}
+		sources.resize(type.components());
+	}
+	return gather(sources, type);
+}
+
+//functions are inlined: the body is parsed again for every call with the parameters bound to copies of the arguments
+Value ShaderKernelCompiler::call(const std::string& function, const std::vector<Value>& args){
+	auto overloads = functions.find(function);
+	if(overloads == functions.end()){
+		return builtin(function, args);
+	}
+	const Function* match = nullptr;
+	for(const Function& candidate : overloads->second){
+		bool same = candidate.parameters.size() == args.size();
+		for(size_t i = 0; same && i < args.size(); i++){
+			same = candidate.parameters[i].first == args[i].type;
+		}
+		if(same){
+			match = &candidate;
+		}
+	}
+	if(!match){
+		error("no overload of " + function + " takes these arguments");
+		return dummy();
+	}
+	if(calls.size() > 32){
+		error("recursion isn't supported");
+		return dummy();
+	}
+	std::unordered_map<std::string, Value> parameters;
+	for(size_t i = 0; i < args.size(); i++){
+		Value parameter = variable(args[i].type);
+		assign(parameter, args[i]);
+		parameters[match->parameters[i].second] = parameter;
+	}
+	size_t returnPosition = position, returnFloor = scopeFloor;
+	scopeFloor = scopes.size();
+	scopes.push_back(parameters);
+	calls.push_back(Call{match->returnType.components() ? temporary(match->returnType) : Value{-1, match->returnType, -1, {}}, false});
+	position = match->body;
+	block();
+	Call done = calls.back();
+	calls.pop_back();
+	scopes.pop_back();
+	scopeFloor = returnFloor;
+	position = returnPosition;
+	if(!done.returned && match->returnType.components()){
+		error(function + " doesn't return a value");
+	}
+	return done.result;
+}
+
+Value ShaderKernelCompiler::swizzle(const Value& value, const std::string& fields){
+	if(value.type.isMatrix() || fields.size() > 4){
+		error("bad swizzle ." + fields);
+		return dummy();
+	}
+	std::vector<int> picked, sources;
+	for(char field : fields){
+		int i = -1;
+		for(const char* set : {"xyzw", "rgba", "stpq"}){
+			if(const char* at = strchr(set, field)){
+				i = int(at - set);
+			}
+		}
+		if(i < 0 || i >= value.type.components()){
+			error("bad swizzle ." + fields);
+			return dummy();
+		}
+		picked.push_back(i);
+		sources.push_back(value.offset + i * L);
+	}
+	Value result = gather(sources, Type{int(fields.size()), 1});
+	if(value.variable >= 0){
+		result.variable = value.variable;
+		for(int i : picked){
+			result.components.push_back(value.components[i]);
+		}
+	}
+	return result;
+}
+
+Value ShaderKernelCompiler::index(const Value& value, int i){
+	int size = value.type.isMatrix() ? value.type.columns : value.type.components();
+	int components = value.type.isMatrix() ? value.type.rows : 1;
+	if(value.type.isScalar() || i < 0 || i >= size){
+		error("index out of range");
+		return dummy();
+	}
+	std::vector<int> sources;
+	for(int c = 0; c < components; c++){
+		sources.push_back(value.offset + (i * components + c) * L);
+	}
+	Value result = gather(sources, Type{components, 1});
+	if(value.variable >= 0){
+		result.variable = value.variable;
+		for(int c = 0; c < components; c++){
+			result.components.push_back(value.components[i * components + c]);
+		}
+	}
+	return result;
+}
+
+//expressions
+std::vector<Value> ShaderKernelCompiler::arguments(){
+	std::vector<Value> args;
+	expect("(");
+	if(accept(")") || (accept("void") && accept(")"))){
+		return args;
+	}
+	do {
+		args.push_back(assignment());
+	} while(!failed && accept(","));
+	expect(")");
+	return args;
+}
+
+Value ShaderKernelCompiler::primary(){
+	const Token token = peek();
+	if(token.kind == Token::Number){
+		position++;
+		return Value{constant(token.number), floatType, -1, {}};
+	}
+	if(accept("(")){
+		Value value = assignment();
+		expect(")");
+		return value;
+	}
+	if(token.kind != Token::Identifier){
+		error("expected an expression but found '" + token.text + "'");
+		return dummy();
+	}
+	position++;
+	if(token.text == "true" || token.text == "false"){
+		return Value{constant(token.text == "true" ? 1.f : 0.f), floatType, -1, {}};
+	}
+	Type type;
+	if(findType(token.text, type)){
+		if(is("[")){
+			error("arrays aren't supported");
+			return dummy();
+		}
+		return construct(token.text, type, arguments());
+	}
+	if(is("(")){
+		return call(token.text, arguments());
+	}
+	Value* value = lookup(token.text);
+	if(!value && token.text == "gl_Position"){
+		return declareSlot(kernel.outputs, token.text, Type{4, 1});
+	}
+	if(!value){
+		error("unknown name " + token.text);
+		return dummy();
+	}
+	return *value;
+}
+
+Value ShaderKernelCompiler::postfix(){
+	Value value = primary();
+	while(!failed){
+		if(accept(".")){
+			value = swizzle(value, identifier());
+		} else if(accept("[")){
+			if(peek().kind != Token::Number){
+				error("only constant indices are supported");
+				return dummy();
+			}
+			value = index(value, int(tokens[position++].number));
+			expect("]");
+		} else if(is("++") || is("--")){
+			error(peek().text + " isn't supported");
+		} else {
+			break;
+		}
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::unary(){
+	if(accept("-")){
+		return map(unary(), [](float x){ return -x; });
+	} else if(accept("!")){
+		return map(unary(), [](float x){ return x != 0.f ? 0.f : 1.f; });
+	} else if(accept("+")){
+		return unary();
+	} else if(is("++") || is("--")){
+		error(peek().text + " isn't supported");
+	}
+	return postfix();
+}
+
+Value ShaderKernelCompiler::multiplicative(){
+	Value value = unary();
+	while(!failed && (is("*") || is("/"))){
+		char op = tokens[position++].text[0];
+		value = arithmetic(op, value, unary());
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::additive(){
+	Value value = multiplicative();
+	while(!failed && (is("+") || is("-"))){
+		char op = tokens[position++].text[0];
+		value = arithmetic(op, value, multiplicative());
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::relational(){
+	Value value = additive();
+	while(!failed && (is("<") || is(">") || is("<=") || is(">="))){
+		std::string op = tokens[position++].text;
+		Value right = additive();
+		if(!value.type.isScalar() || !right.type.isScalar()){
+			error("comparisons only work on scalars");
+		} else if(op == "<"){
+			value = combine(value, right, [](float x, float y){ return x < y ? 1.f : 0.f; });
+		} else if(op == ">"){
+			value = combine(value, right, [](float x, float y){ return x > y ? 1.f : 0.f; });
+		} else if(op == "<="){
+			value = combine(value, right, [](float x, float y){ return x <= y ? 1.f : 0.f; });
+		} else {
+			value = combine(value, right, [](float x, float y){ return x >= y ? 1.f : 0.f; });
+		}
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::equality(){
+	Value value = relational();
+	while(!failed && (is("==") || is("!="))){
+		bool equal = tokens[position++].text == "==";
+		Value right = relational();
+		if(!value.type.isScalar() || !right.type.isScalar()){
+			error("comparisons only work on scalars");
+		} else if(equal){
+			value = combine(value, right, [](float x, float y){ return x == y ? 1.f : 0.f; });
+		} else {
+			value = combine(value, right, [](float x, float y){ return x != y ? 1.f : 0.f; });
+		}
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::logicalAnd(){
+	Value value = equality();
+	while(!failed && accept("&&")){
+		value = combine(value, equality(), [](float x, float y){ return x != 0.f && y != 0.f ? 1.f : 0.f; });
+	}
+	return value;
+}
+
+Value ShaderKernelCompiler::logicalOr(){
+	Value value = logicalAnd();
+	while(!failed && accept("||")){
+		value = combine(value, logicalAnd(), [](float x, float y){ return x != 0.f || y != 0.f ? 1.f : 0.f; });
+	}
+	return value;
+}
+
+//both sides are evaluated, the condition picks per lane
+Value ShaderKernelCompiler::ternary(){
+	Value condition = logicalOr();
+	if(failed || !accept("?")){
+		return condition;
+	}
+	Value a = assignment();
+	expect(":");
+	Value b = assignment();
+	if(!condition.type.isScalar() || a.type != b.type){
+		error("?: needs a scalar condition and two values of the same type");
+		return dummy();
+	}
+	Value result = temporary(a.type);
+	int count = a.type.components(), co = condition.offset, ao = a.offset, bo = b.offset, to = result.offset;
+	kernel.program.push_back([=](float* m){
+		const float* c = m + co;
+		for(int k = 0; k < count; k++){
+			const float* x = m + ao + k * L;
+			const float* y = m + bo + k * L;
+			float* d = m + to + k * L;
+			for(int i = 0; i < L; i++){
+				d[i] = c[i] != 0.f ? x[i] : y[i];
+			}
+		}
+	});
+	return result;
+}
+
+Value ShaderKernelCompiler::assignment(){
+	Value target = ternary();
+	for(const char* op : {"=", "+=", "-=", "*=", "/="}){
+		if(failed || !accept(op)){
+			continue;
+		}
+		if(target.variable < 0){
+			error(std::string("can't assign to the left of ") + op);
+			return dummy();
+		}
+		Value value = assignment();
+		if(op[1]){
+			value = arithmetic(op[0], target, value);
+		}
+		assign(target, value);
+		return value;
+	}
+	return target;
+}
+
+//statements
+void ShaderKernelCompiler::declaration(){
+	accept("const");
+	skipQualifiers();
+	Type declared = type();
+	do {
+		std::string name = identifier();
+		if(is("[")){
+			error("arrays aren't supported");
+			return;
+		}
+		Value value = variable(declared);
+		if(accept("=")){
+			assign(value, assignment());
+		}
+		scopes.back()[name] = value;
+	} while(!failed && accept(","));
+	expect(";");
+}
+
+void ShaderKernelCompiler::statement(){
+	if(!calls.empty() && calls.back().returned){
+		error("only a return at the end of a function is supported");
+		return;
+	}
+	for(const char* keyword : {"if", "for", "while", "do", "switch", "break", "continue", "discard"}){
+		if(is(keyword)){
+			error(std::string(keyword) + " isn't supported");
+			return;
+		}
+	}
+	if(is("{")){
+		block();
+	} else if(accept(";")){
+	} else if(accept("return")){
+		Call& current = calls.back();
+		if(!accept(";")){
+			Value value = assignment();
+			if(current.result.type.components() == 0){
+				error("returning a value from a void function");
+				return;
+			}
+			current.result.variable = current.result.offset;
+			current.result.components.clear();
+			for(int i = 0; i < current.result.type.components(); i++){
+				current.result.components.push_back(i);
+			}
+			assign(current.result, value);
+			current.result.variable = -1;
+			current.result.components.clear();
+			expect(";");
+		}
+		current.returned = true;
+	} else if(is("const") || (peek().kind == Token::Identifier && isQualifier(peek().text)) || (peekType() && peek(1).kind == Token::Identifier)){
+		declaration();
+	} else {
+		assignment();
+		expect(";");
+	}
+}
+
+void ShaderKernelCompiler::block(){
+	expect("{");
+	scopes.push_back(std::unordered_map<std::string, Value>());
+	while(!failed && !accept("}")){
+		if(peek().kind == Token::End){
+			error("expected '}'");
+			break;
+		}
+		statement();
+	}
+	scopes.pop_back();
+}
+
+void ShaderKernelCompiler::function(const Type& returnType, const std::string& name){
+	Function function = {returnType, {}, 0};
+	expect("(");
+	if(!accept(")") && !(accept("void") && accept(")"))){
+		do {
+			skipQualifiers();
+			accept("const");
+			accept("in");
+			if(is("out") || is("inout")){
+				error("out parameters aren't supported");
+				return;
+			}
+			skipQualifiers();
+			Type parameter = type();
+			function.parameters.push_back(std::make_pair(parameter, identifier()));
+		} while(!failed && accept(","));
+		expect(")");
+	}
+	if(failed || accept(";")){
+		return;
+	}
+	function.body = position;
+	expect("{");
+	for(int depth = 1; !failed && depth > 0; position++){
+		if(peek().kind == Token::End){
+			error("expected '}'");
+		} else if(is("{")){
+			depth++;
+		} else if(is("}")){
+			depth--;
+		}
+	}
+	functions[name].push_back(function);
+}
+
+void ShaderKernelCompiler::topLevel(){
+	if(accept(";")){
+		return;
+	}
+	if(accept("precision")){
+		while(!failed && !accept(";")){
+			position++;
+		}
+		return;
+	}
+	//redeclaring an output invariant only keeps a GPU from computing it differently in different programs
+	if(is("invariant") && peek(1).kind == Token::Identifier && peek(2).text == ";"){
+		position += 3;
+		return;
+	}
+	if(accept("layout")){
+		expect("(");
+		while(!failed && !accept(")")){
+			position++;
+		}
+	}
+	std::unordered_map<std::string, ShaderKernel::Slot>* slots = nullptr;
+	for(;;){
+		skipQualifiers();
+		if(accept("in") || accept("attribute")){
+			slots = &kernel.inputs;
+		} else if(accept("out") || accept("varying")){
+			slots = &kernel.outputs;
+		} else if(accept("uniform")){
+			slots = &kernel.uniforms;
+		} else if(!accept("const")){
+			break;
+		}
+	}
+	//uniform blocks, whose members are set like any other uniform
+	if(slots == &kernel.uniforms && !peekType() && peek(1).text == "{"){
+		identifier();
+		expect("{");
+		while(!failed && !accept("}")){
+			skipQualifiers();
+			Type member = type();
+			do {
+				declareSlot(kernel.uniforms, identifier(), member);
+			} while(!failed && accept(","));
+			expect(";");
+		}
+		if(!failed && !accept(";")){
+			error("named uniform blocks aren't supported");
+		}
+		return;
+	}
+	if(!peekType() && peek().kind == Token::Identifier){
+		error("unknown type " + peek().text);
+		return;
+	}
+	Type declared = type();
+	std::string name = identifier();
+	if(is("(")){
+		if(slots){
+			error("a function can't be " + name);
+		}
+		function(declared, name);
+		return;
+	}
+	for(;;){
+		if(is("[")){
+			error("arrays aren't supported");
+			return;
+		}
+		if(slots){
+			declareSlot(*slots, name, declared);
+		} else {
+			Value value = variable(declared);
+			if(accept("=")){
+				assign(value, assignment());
+			}
+			scopes[0][name] = value;
+		}
+		if(failed || !accept(",")){
+			break;
+		}
+		name = identifier();
+	}
+	expect(";");
+}
+
+bool ShaderKernelCompiler::compile(const std::string& source){
+	if(!tokenize(source)){
+		return false;
+	}
+	scopes.push_back(std::unordered_map<std::string, Value>());
+	while(!failed && peek().kind != Token::End){
+		topLevel();
+	}
+	if(failed){
+		return false;
+	}
+	auto main = functions.find("main");
+	if(main == functions.end()){
+		return error("there is no main function");
+	}
+	call("main", std::vector<Value>());
+	return !failed;
+}
+
+//ShaderKernel
+std::unique_ptr<ShaderKernel> ShaderKernel::Create(const std::string& source, const std::string& name){
+	std::unique_ptr<ShaderKernel> kernel(new ShaderKernel());
+	ShaderKernelCompiler compiler(*kernel, name);
+	if(!compiler.compile(source)){
+		printf("Couldn't compile shader kernel %s\n", name.c_str());
+		return std::unique_ptr<ShaderKernel>();
+	}
+	return kernel;
+}
+
+std::unique_ptr<ShaderKernel> ShaderKernel::CreateFromFile(const std::string& filename, const ShaderDefines& defines){
+	std::string source;
+	std::vector<std::string> sources;
+	if(!preprocessShaderFile(filename, defines, source, sources)){
+		return std::unique_ptr<ShaderKernel>();
+	}
+	return Create(source, filename);
+}
+
+const ShaderKernel::Slot* ShaderKernel::find(const std::unordered_map<std::string, Slot>& slots, const std::string& name, int components) const {
+	auto found = slots.find(name);
+	if(found == slots.end() || found->second.components != components){
+		return nullptr;
+	}
+	return &found->second;
+}
+
+bool ShaderKernel::setUniform(const std::string& name, const float* values, int components){
+	const Slot* slot = find(uniforms, name, components);
+	if(!slot){
+		return false;
+	}
+	for(int c = 0; c < components; c++){
+		std::fill_n(memory.begin() + slot->offset + c * Lanes, Lanes, values[c]);
+	}
+	return true;
+}
+
+bool ShaderKernel::setInput(const std::string& name, int lane, const float* values, int components){
+	const Slot* slot = find(inputs, name, components);
+	if(!slot || lane < 0 || lane >= Lanes){
+		return false;
+	}
+	for(int c = 0; c < components; c++){
+		memory[slot->offset + c * Lanes + lane] = values[c];
+	}
+	return true;
+}
+
+bool ShaderKernel::getOutput(const std::string& name, int lane, float* values, int components) const {
+	const Slot* slot = find(outputs, name, components);
+	if(!slot || lane < 0 || lane >= Lanes){
+		return false;
+	}
+	for(int c = 0; c < components; c++){
+		values[c] = memory[slot->offset + c * Lanes + lane];
+	}
+	return true;
+}
+
+void ShaderKernel::run(){
+	float* registers = memory.data();
+	for(auto& operation : program){
+		operation(registers);
+	}
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "shaderpreprocessor.h"
+
+//Runs a vertex or fragment shader on the CPU, Lanes invocations at a time
+//	The source is compiled once into a flat list of operations on registers that hold one value per lane,
+//	so each operation is a short loop over the lanes that the C++ compiler turns into SIMD instructions.
+//	That makes it usable to check shading math on machines without a GPU and to shade offline.
+//	Only the subset of GLSL ES 3.00 the demos use is understood:
+//	- float, int, bool, vec2-4 and mat2-4 (ints and bools are floats), const, in, out, uniform and uniform blocks
+//	- functions, which are inlined, and declarations, assignments and return as their last statement
+//	- the arithmetic, comparison and logical operators, ?:, constructors, swizzles and constant indices
+//	- #define, #undef, #ifdef, #ifndef, #if with a number or defined(), #else and #endif
+//	- the built-in functions the demos call and the common math ones around them (see builtins in shaderkernel.cpp)
+//	Anything else (if, loops, samplers, arrays...) fails Create with a message saying what.
+class ShaderKernel {
+private:
+	friend class ShaderKernelCompiler;
+	struct Slot {
+		int offset;
+		int components;
+	};
+	//component c of lane i of a register at offset is at memory[offset + c * Lanes + i]
+	std::vector<float> memory;
+	std::vector<std::function<void(float*)>> program;
+	std::unordered_map<std::string, Slot> uniforms;
+	std::unordered_map<std::string, Slot> inputs;
+	std::unordered_map<std::string, Slot> outputs;
+	ShaderKernel() {}
+	const Slot* find(const std::unordered_map<std::string, Slot>& slots, const std::string& name, int components) const;
+public:
+	static const int Lanes = 8;
+	//empty if the source doesn't compile, the reason is printed
+	static std::unique_ptr<ShaderKernel> Create(const std::string& source, const std::string& name = "");
+	//runs the file through the same preprocessor as ShaderStage::loadFromFile first
+	static std::unique_ptr<ShaderKernel> CreateFromFile(const std::string& filename, const ShaderDefines& defines = ShaderDefines());
+
+	//Values are floats in the order glUniform* takes them (matrices column major), components has to match the declaration.
+	//	Each returns false if the shader has no such variable or it has a different size.
+	//	Uniforms are the same for every lane and stay set across run() calls.
+	bool setUniform(const std::string& name, const float* values, int components);
+	bool setInput(const std::string& name, int lane, const float* values, int components);
+	bool getOutput(const std::string& name, int lane, float* values, int components) const;
+	//for float and the glm vector and matrix types
+	template<class T>
+	bool setUniform(const std::string& name, const T& value){
+		return setUniform(name, (const float*)&value, int(sizeof(T) / sizeof(float)));
+	}
+	template<class T>
+	bool setInput(const std::string& name, int lane, const T& value){
+		return setInput(name, lane, (const float*)&value, int(sizeof(T) / sizeof(float)));
+	}
+	template<class T>
+	T getOutput(const std::string& name, int lane) const {
+		T value = T();
+		getOutput(name, lane, (float*)&value, int(sizeof(T) / sizeof(float)));
+		return value;
+	}
+	//runs main for every lane
+	void run();
+	size_t getOperationCount() const {
+		return program.size();
+	}
+};
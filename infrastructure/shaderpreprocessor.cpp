@@ -0,0 +1,157 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "shaderpreprocessor.h"
+#include "embeddedshaders.h"
+#include "fileview.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+std::vector<std::string>& shaderIncludePaths(){
+	static std::vector<std::string> paths = {"../shaders"};
+	return paths;
+}
+
+namespace {
+//where the directive starts if the line is the given directive, otherwise nullptr
+const char* directive(const char* line, const char* end, const char* name){
+	while(line < end && (*line == ' ' || *line == '\t')){
+		line++;
+	}
+	size_t length = strlen(name);
+	if(size_t(end - line) < length || memcmp(line, name, length) != 0){
+		return nullptr;
+	}
+	return line;
+}
+
+std::string lineDirective(int line, int source){
+	return "#line " + std::to_string(line) + " " + std::to_string(source) + "\n";
+}
+
+struct ShaderPreprocessor {
+	const ShaderDefines& defines;
+	std::string& output;
+	std::vector<std::string>& sources;
+	bool definesWritten;
+
+	void writeDefines(){
+		for(auto& define : defines){
+			if(define.first != "#version"){
+				output += "#define " + define.first + " " + define.second + "\n";
+			}
+		}
+		definesWritten = true;
+	}
+
+	//text is read in place, only the lines that make it into the output are copied
+	bool expand(const std::string& filename, const FileView& text, int source){
+		int number = 0;
+		for(const char* line = text.begin(); line < text.end();){
+			const char* lineEnd = (const char*)memchr(line, '\n', text.end() - line);
+			if(!lineEnd){
+				lineEnd = text.end();
+			}
+			const char* next = lineEnd == text.end() ? lineEnd : lineEnd + 1;
+			number++;
+			if(!definesWritten && directive(line, lineEnd, "#version")){
+				auto version = defines.find("#version");
+				if(version != defines.end()){
+					output += "#version " + version->second + "\n";
+				} else {
+					output.append(line, lineEnd).append("\n");
+				}
+				writeDefines();
+				output += lineDirective(number + 1, source);
+				line = next;
+				continue;
+			}
+			const char* include = directive(line, lineEnd, "#include");
+			if(!include){
+				output.append(line, lineEnd).append("\n");
+				line = next;
+				continue;
+			}
+			line = next;
+			const char* open = std::find(include, lineEnd, '"');
+			const char* close = open == lineEnd ? lineEnd : std::find(open + 1, lineEnd, '"');
+			if(close == lineEnd){
+				printf("%s:%d: expected #include \"file\"\n", filename.c_str(), number);
+				return false;
+			}
+			std::string name(open + 1, close);
+			//next to the including file first, then the shared folders
+			std::vector<std::string> candidates;
+			size_t slash = filename.find_last_of("/\\");
+			candidates.push_back(slash == std::string::npos ? name : filename.substr(0, slash + 1) + name);
+			for(auto& path : shaderIncludePaths()){
+				candidates.push_back(path + "/" + name);
+			}
+			std::unique_ptr<FileView> contents;
+			auto found = std::find_if(candidates.begin(), candidates.end(), [&](const std::string& candidate){
+				contents = openShaderFile(candidate);
+				return contents != nullptr;
+			});
+			if(found == candidates.end()){
+				printf("%s:%d: couldn't find %s\n", filename.c_str(), number, name.c_str());
+				return false;
+			}
+			if(std::find(sources.begin(), sources.end(), *found) == sources.end()){
+				sources.push_back(*found);
+				int included = sources.size() - 1;
+				output += lineDirective(1, included);
+				if(!expand(*found, *contents, included)){
+					return false;
+				}
+			}
+			output += lineDirective(number + 1, source);
+		}
+		return true;
+	}
+};
+}
+
+bool preprocessShaderFile(const std::string& filename, const ShaderDefines& defines, std::string& output, std::vector<std::string>& sources){
+	std::unique_ptr<FileView> text = openShaderFile(filename);
+	if(!text){
+		printf("couldn't open %s\n", filename.c_str());
+		return false;
+	}
+	output.clear();
+	sources.assign(1, filename);
+	ShaderPreprocessor preprocessor = {defines, output, sources, false};
+	if(!preprocessor.expand(filename, *text, 0)){
+		return false;
+	}
+	if(!preprocessor.definesWritten && !defines.empty()){
+		//no #version line, so the defines can go first
+		std::string body;
+		body.swap(output);
+		auto version = defines.find("#version");
+		if(version != defines.end()){
+			output += "#version " + version->second + "\n";
+		}
+		preprocessor.writeDefines();
+		output += lineDirective(1, 0) + body;
+	}
+	return true;
+}
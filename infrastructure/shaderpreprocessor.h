@@ -0,0 +1,39 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+//name -> value, each becomes "#define name value" right after the #version line
+//	The name "#version" instead replaces the file's own #version line, so one file can be built at another GLSL version.
+typedef std::map<std::string, std::string> ShaderDefines;
+
+//Directories searched for #include "file" when it isn't next to the file including it
+//	Starts out as ../shaders, the shared folder beside the demo folders.
+std::vector<std::string>& shaderIncludePaths();
+
+//Reads filename (or its embedded copy, see embeddedshaders.h) and splices in its #include "file" lines, each file only once no matter how often it is included
+//	#line directives keep error messages pointing at the right line: source string 0 is filename and
+//	the included files count up from 1 in the order they are added to sources.
+//	Returns false and prints why if a file can't be read.
+bool preprocessShaderFile(const std::string& filename, const ShaderDefines& defines, std::string& output, std::vector<std::string>& sources);
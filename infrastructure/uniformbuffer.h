@@ -0,0 +1,75 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include "gldispatch.h"
+#include "glm/glm.hpp"
+#include <memory>
+
+//std140 layout of the FrameData uniform block every demo shader declares
+//	vec3 members take 16 bytes in std140, hence the padding
+struct FrameUniforms {
+	glm::mat4 projectionMatrix;
+	glm::mat4 viewMatrix;
+	glm::vec3 cameraWorldPosition;
+	float padding0 = 0.f;
+	glm::vec3 lightPosition;
+	float padding1 = 0.f;
+	glm::vec3 lightColor;
+	float padding2 = 0.f;
+};
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 FrameData block");
+//binding point FrameData is attached to, see Shader::bindUniformBlock
+const GLuint FrameUniformsBinding = 0;
+//binding point of the per draw DrawData block, see RenderQueue::streamDrawData
+const GLuint DrawDataBinding = 1;
+
+//A uniform buffer holding one T, bound to a fixed binding point for every program to read
+//	T has to match the std140 layout of the block in the shaders.
+template<class T>
+class UniformBuffer {
+private:
+	GLuint ubo;
+	GLuint binding;
+	UniformBuffer(GLuint binding) : binding(binding) {
+		glGenBuffers(1,&ubo);
+		glBindBuffer(GL_UNIFORM_BUFFER,ubo);
+		glBufferData(GL_UNIFORM_BUFFER,sizeof(T),nullptr,GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER,binding,ubo);
+	}
+public:
+	static std::unique_ptr<UniformBuffer<T>> Create(GLuint binding){
+		return std::unique_ptr<UniformBuffer<T>>(new UniformBuffer<T>(binding));
+	}
+	~UniformBuffer(){
+		glDeleteBuffers(1,&ubo);
+	}
+	//one upload no matter how many programs read it
+	void update(const T& value){
+		glBindBuffer(GL_UNIFORM_BUFFER,ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER,0,sizeof(T),&value);
+	}
+	//only needed if something else was bound to the binding point since
+	void bind(){
+		glBindBufferBase(GL_UNIFORM_BUFFER,binding,ubo);
+	}
+};
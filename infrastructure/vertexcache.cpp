@@ -0,0 +1,197 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "vertexcache.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+size_t findIndexOutOfRange(const GLuint* indices, size_t indexCount, size_t vertexCount){
+	for(size_t i=0;i<indexCount;i++){
+		if(indices[i] >= vertexCount){
+			return i;
+		}
+	}
+	return indexCount;
+}
+
+VertexCacheStats measureVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize){
+	//a vertex is still cached if fewer than cacheSize others were transformed after it
+	std::vector<size_t> transformedAt(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses = 0, usedCount = 0;
+	for(size_t i=0;i<indexCount;i++){
+		GLuint v = indices[i];
+		if(!used[v] || misses - transformedAt[v] >= cacheSize){
+			if(!used[v]){
+				used[v] = true;
+				usedCount++;
+			}
+			misses++;
+			transformedAt[v] = misses;
+		}
+	}
+	VertexCacheStats stats;
+	stats.acmr = indexCount < 3 ? 0.f : float(misses) / float(indexCount / 3);
+	stats.atvr = usedCount == 0 ? 0.f : float(misses) / float(usedCount);
+	return stats;
+}
+
+namespace {
+//the constants from Forsyth's article
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.f;
+const float ValenceBoostPower = 0.5f;
+const size_t ValenceTableSize = 32;
+
+struct ScoreTables {
+	float cache[VertexCacheSize];
+	float valence[ValenceTableSize];
+	ScoreTables(){
+		for(unsigned int i=0;i<VertexCacheSize;i++){
+			//the last triangle's three vertices score the same so it doesn't matter which of them it ended with
+			cache[i] = i < 3 ? LastTriangleScore : std::pow(1.f - float(i - 3) / float(VertexCacheSize - 3), CacheDecayPower);
+		}
+		valence[0] = 0.f;
+		for(size_t i=1;i<ValenceTableSize;i++){
+			valence[i] = ValenceBoostScale * std::pow(float(i), -ValenceBoostPower);
+		}
+	}
+};
+
+//cachePosition is -1 outside the cache, a vertex without triangles left scores -1 so it's never chosen from
+float vertexScore(const ScoreTables& tables, int cachePosition, size_t trianglesLeft){
+	if(trianglesLeft == 0){
+		return -1.f;
+	}
+	float score = cachePosition < 0 ? 0.f : tables.cache[cachePosition];
+	return score + (trianglesLeft < ValenceTableSize ? tables.valence[trianglesLeft] : ValenceBoostScale * std::pow(float(trianglesLeft), -ValenceBoostPower));
+}
+}
+
+void optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount){
+	static const ScoreTables tables;
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount < 2){
+		return;
+	}
+	//the triangles using each vertex, as ranges of one shared array; a vertex's range shrinks as its triangles are emitted
+	std::vector<size_t> firstTriangle(vertexCount + 1, 0);
+	for(size_t i=0;i<triangleCount*3;i++){
+		firstTriangle[indices[i] + 1]++;
+	}
+	for(size_t v=0;v<vertexCount;v++){
+		firstTriangle[v + 1] += firstTriangle[v];
+	}
+	std::vector<size_t> trianglesLeft(vertexCount);
+	for(size_t v=0;v<vertexCount;v++){
+		trianglesLeft[v] = firstTriangle[v + 1] - firstTriangle[v];
+	}
+	std::vector<size_t> vertexTriangles(triangleCount * 3);
+	{
+		std::vector<size_t> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+		for(size_t t=0;t<triangleCount;t++){
+			for(int c=0;c<3;c++){
+				vertexTriangles[filled[indices[t*3+c]]++] = t;
+			}
+		}
+	}
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> score(vertexCount);
+	for(size_t v=0;v<vertexCount;v++){
+		score[v] = vertexScore(tables, -1, trianglesLeft[v]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for(size_t t=0;t<triangleCount;t++){
+		triangleScore[t] = score[indices[t*3]] + score[indices[t*3+1]] + score[indices[t*3+2]];
+	}
+	std::vector<GLuint> ordered(triangleCount * 3);
+	//the three vertices of the triangle being added can push the cache 3 past its size before the rest drop off
+	GLuint cache[VertexCacheSize + 3];
+	size_t cacheCount = 0;
+	size_t best = 0;
+	for(size_t t=1;t<triangleCount;t++){
+		if(triangleScore[t] > triangleScore[best]){
+			best = t;
+		}
+	}
+	//where to look for a new starting triangle once nothing in the cache has triangles left
+	size_t nextUnemitted = 0;
+	for(size_t out=0;out<triangleCount;out++){
+		if(best == triangleCount){
+			while(emitted[nextUnemitted]){
+				nextUnemitted++;
+			}
+			best = nextUnemitted;
+		}
+		const GLuint* triangle = indices + best * 3;
+		std::copy(triangle, triangle + 3, ordered.begin() + out * 3);
+		emitted[best] = true;
+		GLuint newCache[VertexCacheSize + 3];
+		size_t newCount = 0;
+		for(int c=0;c<3;c++){
+			GLuint v = triangle[c];
+			//take the triangle out of the vertex's list
+			size_t* begin = vertexTriangles.data() + firstTriangle[v];
+			size_t* end = begin + trianglesLeft[v];
+			std::iter_swap(std::find(begin, end, best), end - 1);
+			trianglesLeft[v]--;
+			if(std::find(newCache, newCache + newCount, v) == newCache + newCount){
+				newCache[newCount++] = v;
+			}
+		}
+		for(size_t i=0;i<cacheCount;i++){
+			GLuint v = cache[i];
+			if(v != triangle[0] && v != triangle[1] && v != triangle[2]){
+				newCache[newCount++] = v;
+			}
+		}
+		for(size_t i=VertexCacheSize;i<newCount;i++){
+			//dropped out of the cache
+			cachePosition[newCache[i]] = -1;
+			score[newCache[i]] = vertexScore(tables, -1, trianglesLeft[newCache[i]]);
+		}
+		cacheCount = std::min(newCount, size_t(VertexCacheSize));
+		std::copy(newCache, newCache + cacheCount, cache);
+		for(size_t i=0;i<cacheCount;i++){
+			cachePosition[cache[i]] = int(i);
+			score[cache[i]] = vertexScore(tables, int(i), trianglesLeft[cache[i]]);
+		}
+		//only triangles of cached vertices changed score enough to matter, the best of them goes next
+		best = triangleCount;
+		float bestScore = -1.f;
+		for(size_t i=0;i<newCount;i++){
+			GLuint v = newCache[i];
+			for(size_t n=0;n<trianglesLeft[v];n++){
+				size_t t = vertexTriangles[firstTriangle[v] + n];
+				const GLuint* corners = indices + t * 3;
+				triangleScore[t] = score[corners[0]] + score[corners[1]] + score[corners[2]];
+				if(triangleScore[t] > bestScore){
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+	}
+	std::copy(ordered.begin(), ordered.end(), indices);
+}
@@ -0,0 +1,49 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+//How well a triangle list reuses vertices the GPU has already run the vertex shader on,
+//	measured with a first in first out cache of transformed vertices like older hardware has
+struct VertexCacheStats {
+	//average cache miss ratio, vertex shader runs per triangle: 3 is no reuse at all, a large regular mesh can get near 0.5
+	float acmr;
+	//average transformed vertex ratio, vertex shader runs per vertex the triangles use: 1 is ideal
+	float atvr;
+};
+
+//The size optimizeVertexCache orders for, and measureVertexCache's default
+const unsigned int VertexCacheSize = 32;
+
+//Where the first index of vertexCount or more is, indexCount if there is none
+//	measureVertexCache and optimizeVertexCache keep a slot per vertex and trust every index to have one, so check first.
+size_t findIndexOutOfRange(const GLuint* indices, size_t indexCount, size_t vertexCount);
+
+VertexCacheStats measureVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = VertexCacheSize);
+
+//Reorders the triangles of an indexed triangle list so neighbouring triangles follow each other
+//	Tom Forsyth's linear speed vertex cache optimisation: each step emits the best scoring triangle among those
+//	touching the vertices last used, scoring vertices by how recently they were used and how few triangles they have left.
+//	It doesn't assume an exact cache size, so the order works about as well on any hardware.
+//	Only the order of triangles changes, each triangle keeps its vertices and its winding.
+void optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount);
@@ -0,0 +1,89 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(unsigned int workerCount) : generation(0), running(0), stopping(false) {
+#ifndef __EMSCRIPTEN__
+	if(workerCount == 0){
+		workerCount = std::thread::hardware_concurrency();
+	}
+	for(unsigned int i=1;i<workerCount;i++){
+		threads.emplace_back(&WorkerPool::work, this, i);
+	}
+#endif
+}
+
+WorkerPool::~WorkerPool(){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(std::thread& thread : threads){
+		thread.join();
+	}
+}
+
+void WorkerPool::work(unsigned int worker){
+	unsigned int seen = 0;
+	while(true){
+		std::function<void(unsigned int)> current;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]{ return stopping || generation != seen; });
+			if(stopping){
+				return;
+			}
+			seen = generation;
+			current = job;
+		}
+		current(worker);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running--;
+		}
+		finished.notify_one();
+	}
+}
+
+void WorkerPool::parallelFor(size_t count, std::function<void(unsigned int worker, size_t begin, size_t end)> body){
+	unsigned int workers = getWorkerCount();
+	auto range = [=](unsigned int worker){
+		size_t begin = count * worker / workers;
+		size_t end = count * (worker + 1) / workers;
+		body(worker, begin, end);
+	};
+	if(workers == 1){
+		range(0);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = range;
+		running = workers - 1;
+		generation++;
+	}
+	wake.notify_all();
+	range(0);
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [&]{ return running == 0; });
+}
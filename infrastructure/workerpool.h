@@ -0,0 +1,56 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//A fixed set of threads that split loops between them
+//	The thread calling parallelFor works as worker 0, so a pool of one worker runs everything inline.
+//	Under emscripten there are no threads and every pool has one worker.
+class WorkerPool {
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::function<void(unsigned int)> job;
+	unsigned int generation;
+	unsigned int running;
+	bool stopping;
+	void work(unsigned int worker);
+public:
+	//0 uses one worker per hardware thread
+	WorkerPool(unsigned int workerCount = 0);
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	unsigned int getWorkerCount(){
+		return unsigned(threads.size()) + 1;
+	}
+	//splits [0,count) into one contiguous range per worker and waits for all of them
+	//	body gets the worker index (always below getWorkerCount()) and its range, which may be empty
+	void parallelFor(size_t count, std::function<void(unsigned int worker, size_t begin, size_t end)> body);
+};
@@ -88,10 +88,11 @@ int main(int argc, char* argv[]){
 		waitForExit(window);
 		return -1;
 	}
-	//now to pass in our transform matrices we need to get the location of the uniforms
+	//now to pass in our transform matrices we need handles to the uniforms
+	//	they remember what was last uploaded, so the projection only goes to the GPU again after a resize
 	shader->bind();
-	GLint projectionMatrixIndex = glGetUniformLocation(shader->getId(),"in_projectionMatrix");
-	GLint modelViewMatrixIndex = glGetUniformLocation(shader->getId(),"in_modelViewMatrix");
+	Uniform<glm::mat4> projectionMatrixUniform = shader->uniform<glm::mat4>("in_projectionMatrix");
+	Uniform<glm::mat4> modelViewMatrixUniform = shader->uniform<glm::mat4>("in_modelViewMatrix");
 
 	GLuint vao; 
 	GLuint vbo; 
@@ -140,6 +141,8 @@ int main(int argc, char* argv[]){
 	auto main_loop = [=]() mutable {
 		//first poll for events
 		glfwPollEvents();
+		//picks up edits to the shader files
+		shader->reload();
 
 		//let's make our rectangle spin
 		modelMatrix = glm::rotate(modelMatrix,0.5f,glm::vec3(0.f,1.f,0.f));
@@ -148,15 +151,15 @@ int main(int argc, char* argv[]){
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
 		shader->bind();
-		glUniformMatrix4fv(projectionMatrixIndex,1,false,glm::value_ptr(projectionMatrix));
-		glUniformMatrix4fv(modelViewMatrixIndex,1,false,glm::value_ptr(viewMatrix * modelMatrix));
+		projectionMatrixUniform.set(projectionMatrix);
+		modelViewMatrixUniform.set(viewMatrix * modelMatrix);
 		glBindVertexArray(vao); //and our vertex data declared by the vertex array object
 		//Draw!
 		glDrawArrays(GL_TRIANGLE_STRIP, //We're using triangle strips
 			0,4); //the first 4 vertices (all of the ones in our buffer in our case)
 
 		//finally, update the screen
-		glfwSwapBuffers(window);
+		swapBuffers(window);
 	};
 
 #ifdef __EMSCRIPTEN__
@@ -8,8 +8,7 @@ in vec3 vs_LightVector;
 in vec3 vs_WorldPosition;
 in float vs_LightDistance;
 
-uniform vec3 lightPosition;
-uniform vec3 lightColor;
+#include "framedata.glsl"
 
 out vec4 fragColor;
 
@@ -28,7 +28,8 @@ THE SOFTWARE.
 #include <string>
 #include "infrastructure.h"
 #include "shader.h"
-#include "geometry.h"
+#include "mesh.h"
+#include "uniformbuffer.h"
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 
@@ -82,7 +83,7 @@ int main(int argc, char* argv[]){
 	glClearColor(0.1f,0.1f,0.1f,1.0f);
 
 	//compile our shader
-	std::shared_ptr<Shader> lightingShader = Shader::Create("mvpNormals.vert","lighting.frag");
+	std::shared_ptr<Shader> lightingShader = Shader::Create("../shaders/mvpNormals.vert","lighting.frag");
 	if(!lightingShader){
 		//compiling one of the shaders failed
 		waitForExit(window);
@@ -91,56 +92,63 @@ int main(int argc, char* argv[]){
 	lightingShader->bindAttrib(0,"in_Position");
 	lightingShader->bindAttrib(1,"in_Normal");
 	lightingShader->bindAttrib(2,"in_TexCoord");
-	if(!lightingShader->link()){
-		printf("linking shader program failed :(");
-		waitForExit(window);
-		return -1;
-	}
-	//now to pass in our transform matrices we need to get the location of the uniforms
-	lightingShader->bind();
-	GLint projectionMatrixIndex = glGetUniformLocation(lightingShader->getId(),"projectionMatrix");
-	GLint viewMatrixIndex = glGetUniformLocation(lightingShader->getId(),"viewMatrix");
-	GLint modelMatrixIndex = glGetUniformLocation(lightingShader->getId(),"modelMatrix");
-	GLint cameraIndex = glGetUniformLocation(lightingShader->getId(),"cameraWorldPosition");
-	GLint lightIndex = glGetUniformLocation(lightingShader->getId(),"lightPosition");
-	GLint lightColorIndex = glGetUniformLocation(lightingShader->getId(),"lightColor");
+	//both programs are started before either is waited on, so the driver can compile them side by side
+	lightingShader->linkAsync();
 
 #ifndef __EMSCRIPTEN__
-	std::shared_ptr<Shader> normalShader = Shader::Create("mvpNormals.vert","attribColor.frag");
+	//geometry shaders are desktop GLSL, and every stage of a program has to be the same version,
+	//	so the shared vertex stage is built at #version 330 for this one
+	ShaderPermutations normalStages;
+	std::shared_ptr<Shader> normalShader = Shader::Create(
+		normalStages.get(GL_VERTEX_SHADER, "../shaders/mvpNormals.vert", ShaderDefines{{"#version", "330"}}),
+		normalStages.get(GL_FRAGMENT_SHADER, "../shaders/attribColor.frag"));
 	if(!normalShader){
-		//compiling one of the shaders failed
+		//loading one of the shaders failed
 		waitForExit(window);
 		return -1;
 	}
 	//attach a geometry shader
-	auto gs = ShaderStage::Create(GL_GEOMETRY_SHADER);
-	if(!gs->compileFromFile("ssnormals.geom")){
-		printf("Compiling geometry shader failed :(");
+	auto gs = normalStages.get(GL_GEOMETRY_SHADER, "../shaders/ssnormals.geom");
+	if(!gs){
+		printf("Loading geometry shader failed :(");
 		waitForExit(window);
 		return -1;
 	}
-	normalShader->attach(std::move(gs));
+	normalShader->attach(gs);
 	normalShader->bindAttrib(0,"in_Position");
 	normalShader->bindAttrib(1,"in_Normal");
 	normalShader->bindAttrib(2,"in_TexCoord");
-	if(!normalShader->link()){
+	normalShader->linkAsync();
+#endif
+
+	if(!lightingShader->finishLink()){
 		printf("linking shader program failed :(");
 		waitForExit(window);
 		return -1;
 	}
-	//now to pass in our transform matrices we need to get the location of the uniforms
+	//the camera and light are the same for every program, they come from one uniform buffer
+	lightingShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+	//now to pass in our transform matrices we need handles to the uniforms
+	lightingShader->bind();
+	Uniform<glm::mat4> modelMatrixUniform = lightingShader->uniform<glm::mat4>("modelMatrix");
+#ifndef __EMSCRIPTEN__
+	if(!normalShader->finishLink()){
+		printf("linking shader program failed :(");
+		waitForExit(window);
+		return -1;
+	}
+	normalShader->bindUniformBlock("FrameData",FrameUniformsBinding);
+	//now to pass in our transform matrices we need handles to the uniforms
 	normalShader->bind();
-	GLint normalProjectionMatrixIndex = glGetUniformLocation(normalShader->getId(),"projectionMatrix");
-	GLint normalViewMatrixIndex = glGetUniformLocation(normalShader->getId(),"viewMatrix");
-	GLint normalModelMatrixIndex = glGetUniformLocation(normalShader->getId(),"modelMatrix");
-	GLint normalLengthIndex = glGetUniformLocation(normalShader->getId(),"normalLength");
-	GLint normalLightIndex = glGetUniformLocation(normalShader->getId(),"lightPosition");
+	Uniform<glm::mat4> normalModelMatrixUniform = normalShader->uniform<glm::mat4>("modelMatrix");
+	//set every frame, but only uploaded once since it never changes
+	Uniform<GLfloat> normalLengthUniform = normalShader->uniform<GLfloat>("normalLength");
 #endif
+	std::shared_ptr<UniformBuffer<FrameUniforms>> frameUniforms = UniformBuffer<FrameUniforms>::Create(FrameUniformsBinding);
+	FrameUniforms frame;
 
-	//Geometry<Plane> bb;
-	IndexedGeometry<SharpCube> bb2;
-	//bb.init();
-	bb2.init();
+	//std::shared_ptr<MeshBuffers> bb = MeshBuffers::Create(Mesh::FromShape<Plane>(), VertexLayout::Interleaved());
+	std::shared_ptr<MeshBuffers> bb2 = MeshBuffers::Create(Mesh::FromShape<SharpCube>(), VertexLayout::Interleaved());
 	
 	//pick some positions for the camera and a light
 	glm::vec3 cameraPosition = glm::vec3(0.f,2.f,4.f);
@@ -162,6 +170,11 @@ int main(int argc, char* argv[]){
 	auto main_loop = [=]() mutable {
 		//first poll for events
 		glfwPollEvents();
+		//picks up edits to the shader files
+		lightingShader->reload();
+#ifndef __EMSCRIPTEN__
+		normalShader->reload();
+#endif
 
 		//let's make our cube spin
 		modelMatrix = glm::rotate(modelMatrix,0.5f,glm::vec3(0.f,1.f,0.f));
@@ -174,28 +187,28 @@ int main(int argc, char* argv[]){
 		//clear the screen
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
+		//one upload for both programs
+		frame.projectionMatrix = projectionMatrix;
+		frame.viewMatrix = viewMatrix;
+		frame.cameraWorldPosition = cameraPosition;
+		frame.lightPosition = lightPosition;
+		frame.lightColor = lightColor;
+		frameUniforms->update(frame);
+
 		lightingShader->bind();
-		glUniformMatrix4fv(projectionMatrixIndex,1,false,glm::value_ptr(projectionMatrix));
-		glUniformMatrix4fv(viewMatrixIndex,1,false,glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(modelMatrixIndex,1,false,glm::value_ptr(modelMatrix));
-		glUniform3f(cameraIndex,cameraPosition.x,cameraPosition.y,cameraPosition.z);
-		glUniform3f(lightIndex,lightPosition.x,lightPosition.y,lightPosition.z);
-		glUniform3f(lightColorIndex,lightColor.r,lightColor.g,lightColor.b);
-		//bb.draw();
-		bb2.draw();
+		modelMatrixUniform.set(modelMatrix);
+		//bb->draw();
+		bb2->draw();
 #ifndef __EMSCRIPTEN__
 		normalShader->bind();
-		glUniformMatrix4fv(normalProjectionMatrixIndex,1,false,glm::value_ptr(projectionMatrix));
-		glUniformMatrix4fv(normalViewMatrixIndex,1,false,glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(normalModelMatrixIndex,1,false,glm::value_ptr(modelMatrix));
-		glUniform1f(normalLengthIndex,0.5f);
-		glUniform3f(normalLightIndex,lightPosition.x,lightPosition.y,lightPosition.z);
-		//bb.draw();
-		bb2.draw();
+		normalModelMatrixUniform.set(modelMatrix);
+		normalLengthUniform.set(0.5f);
+		//bb->draw();
+		bb2->draw();
 #endif
 
 		//finally, update the screen
-		glfwSwapBuffers(window);
+		swapBuffers(window);
 	};
 
 #ifdef __EMSCRIPTEN__
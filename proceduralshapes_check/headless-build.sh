@@ -0,0 +1 @@
+ gcc -c -O2 -DGLEW_STATIC -DGLEW_EGL -DGLEW_NO_GLU -I ../glew/include ../glew/glew.c && g++ -std=c++14 -O2 -DGLEW_STATIC -DGLEW_EGL -DGLEW_NO_GLU -DGLM_FORCE_PURE -I ../infrastructure -I ../glew/include ../infrastructure/proceduralshapes.cpp ../infrastructure/mesh.cpp ../infrastructure/vertexcache.cpp ../infrastructure/workerpool.cpp ../infrastructure/gldispatch.cpp proceduralshapes_check.cpp glew.o -o proceduralshapes_check -lEGL -lGL -lpthread && rm -f *.o && ./proceduralshapes_check
@@ -0,0 +1,209 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include "proceduralshapes.h"
+#include "workerpool.h"
+#include "glm/glm.hpp"
+
+/*
+Procedural Shapes Check
+*************************
+Generates every shape in proceduralshapes.h at several levels of detail and checks what the header promises:
+- the same mesh, byte for byte, with and without a WorkerPool splitting the work into chunks
+- every triangle has an area and winds counterclockwise seen from the side its normals point to
+- the closed shapes have no holes: welding vertices at the same position, every edge is crossed
+  once in each direction, and the grid's inside edges are too
+- everything fits in -1 to 1 and the normals are unit length
+Exits with 1 if any of it doesn't hold.
+*/
+
+namespace {
+int failures = 0;
+
+void fail(const std::string& shape, const char* what){
+	if(failures < 20){
+		printf("%s: %s\n", shape.c_str(), what);
+	}
+	failures++;
+}
+
+bool sameValues(const Mesh& a, const Mesh& b){
+	for(GLuint location : {PositionAttribute, NormalAttribute, TexCoordAttribute}){
+		const std::vector<float>* valuesA = a.getAttribute(location);
+		const std::vector<float>* valuesB = b.getAttribute(location);
+		if(!valuesA || !valuesB || valuesA->size() != valuesB->size()
+			|| memcmp(valuesA->data(), valuesB->data(), valuesA->size() * sizeof(float)) != 0){
+			return false;
+		}
+	}
+	return a.getIndices() == b.getIndices();
+}
+
+glm::vec3 vertexAt(const std::vector<float>& values, GLuint v){
+	return glm::vec3(values[v*3], values[v*3+1], values[v*3+2]);
+}
+
+//vertices at the same position get the same id, the seams and poles repeat positions with other texture coordinates
+std::vector<GLuint> weld(const std::vector<float>& positions){
+	std::map<std::tuple<float,float,float>, GLuint> ids;
+	std::vector<GLuint> welded(positions.size() / 3);
+	for(size_t v=0;v<welded.size();v++){
+		//adding 0 turns -0 into 0, the poles have both
+		auto key = std::make_tuple(positions[v*3] + 0.f, positions[v*3+1] + 0.f, positions[v*3+2] + 0.f);
+		welded[v] = ids.emplace(key, GLuint(ids.size())).first->second;
+	}
+	return welded;
+}
+
+void checkShape(const std::string& shape, bool closed, const std::function<Mesh(WorkerPool*)>& generate, WorkerPool& pool){
+	Mesh mesh = generate(nullptr);
+	const std::vector<float>* positions = mesh.getAttribute(PositionAttribute);
+	const std::vector<float>* normals = mesh.getAttribute(NormalAttribute);
+	const std::vector<GLuint>& indices = mesh.getIndices();
+	if(!positions || !normals || !mesh.getAttribute(TexCoordAttribute) || indices.empty() || mesh.getPrimitiveType() != GL_TRIANGLES){
+		fail(shape, "isn't an indexed triangle list with positions, normals and texture coordinates");
+		return;
+	}
+	if(!sameValues(mesh, generate(&pool))){
+		fail(shape, "comes out different with a WorkerPool");
+	}
+	for(size_t v=0;v<mesh.getVertexCount();v++){
+		glm::vec3 position = vertexAt(*positions, GLuint(v));
+		if(std::abs(position.x) > 1.f + 1e-6f || std::abs(position.y) > 1.f + 1e-6f || std::abs(position.z) > 1.f + 1e-6f){
+			fail(shape, "doesn't fit in -1 to 1");
+			break;
+		}
+		if(std::abs(glm::length(vertexAt(*normals, GLuint(v))) - 1.f) > 1e-5f){
+			fail(shape, "has a normal that isn't unit length");
+			break;
+		}
+	}
+	std::vector<GLuint> welded = weld(*positions);
+	std::map<std::pair<GLuint,GLuint>, int> edges;
+	bool degenerate = false, inward = false;
+	for(size_t i=0;i+2<indices.size();i+=3){
+		GLuint corners[3] = {indices[i], indices[i+1], indices[i+2]};
+		glm::vec3 a = vertexAt(*positions, corners[0]), b = vertexAt(*positions, corners[1]), c = vertexAt(*positions, corners[2]);
+		glm::vec3 face = glm::cross(b - a, c - a);
+		glm::vec3 normal = vertexAt(*normals, corners[0]) + vertexAt(*normals, corners[1]) + vertexAt(*normals, corners[2]);
+		degenerate = degenerate || !(glm::length(face) > 0.f);
+		inward = inward || !(glm::dot(face, normal) > 0.f);
+		for(int e=0;e<3;e++){
+			edges[std::make_pair(welded[corners[e]], welded[corners[(e+1)%3]])]++;
+		}
+	}
+	if(degenerate){
+		fail(shape, "has a triangle without area");
+	}
+	if(inward){
+		fail(shape, "has a triangle winding clockwise seen from its normals");
+	}
+	//each edge once in each direction, only the grid's border has no way back
+	bool twice = false, open = false;
+	for(auto& edge : edges){
+		twice = twice || edge.second != 1;
+		open = open || edges.find(std::make_pair(edge.first.second, edge.first.first)) == edges.end();
+	}
+	if(twice){
+		fail(shape, "has an edge two triangles cross in the same direction");
+	}
+	if(closed && open){
+		fail(shape, "has a hole");
+	}
+	printf("%s: %zu vertices, %zu triangles\n", shape.c_str(), mesh.getVertexCount(), indices.size() / 3);
+}
+
+//the grid's border is the only open edge it may have, columns * 2 + rows * 2 of them
+void checkGridBorder(int columns, int rows){
+	Mesh mesh = generateGrid(columns, rows);
+	const std::vector<GLuint>& indices = mesh.getIndices();
+	std::map<std::pair<GLuint,GLuint>, int> edges;
+	for(size_t i=0;i+2<indices.size();i+=3){
+		for(int e=0;e<3;e++){
+			edges[std::make_pair(indices[i+e], indices[i+(e+1)%3])]++;
+		}
+	}
+	int border = 0;
+	for(auto& edge : edges){
+		border += edges.find(std::make_pair(edge.first.second, edge.first.first)) == edges.end() ? 1 : 0;
+	}
+	if(border != 2 * (columns + rows)){
+		fail("grid " + std::to_string(columns) + "x" + std::to_string(rows), "has an open edge inside");
+	}
+}
+}
+
+int main(){
+	//more workers than a small shape has rows, and a count that doesn't divide evenly
+	WorkerPool pool(5);
+	const int grids[][2] = {{1, 1}, {7, 5}, {64, 33}};
+	for(auto& grid : grids){
+		checkShape("grid " + std::to_string(grid[0]) + "x" + std::to_string(grid[1]), false, [&](WorkerPool* p){
+			return generateGrid(grid[0], grid[1], p);
+		}, pool);
+		checkGridBorder(grid[0], grid[1]);
+	}
+	const int spheres[][2] = {{3, 2}, {16, 8}, {61, 30}};
+	for(auto& sphere : spheres){
+		checkShape("UV sphere " + std::to_string(sphere[0]) + "x" + std::to_string(sphere[1]), true, [&](WorkerPool* p){
+			return generateUVSphere(sphere[0], sphere[1], p);
+		}, pool);
+	}
+	for(int divisions : {1, 2, 5, 16}){
+		checkShape("icosphere " + std::to_string(divisions), true, [&](WorkerPool* p){
+			return generateIcosphere(divisions, p);
+		}, pool);
+	}
+	const int tori[][2] = {{3, 3}, {24, 12}, {41, 17}};
+	const float tubes[] = {0.5f, 0.25f, 0.1f};
+	for(int i=0;i<3;i++){
+		checkShape("torus " + std::to_string(tori[i][0]) + "x" + std::to_string(tori[i][1]), true, [&](WorkerPool* p){
+			return generateTorus(tori[i][0], tori[i][1], tubes[i], p);
+		}, pool);
+	}
+	const int cylinders[][2] = {{3, 1}, {24, 4}, {50, 7}};
+	for(auto& cylinder : cylinders){
+		checkShape("cylinder " + std::to_string(cylinder[0]) + "x" + std::to_string(cylinder[1]), true, [&](WorkerPool* p){
+			return generateCylinder(cylinder[0], cylinder[1], p);
+		}, pool);
+	}
+	//bad parameters give an empty mesh
+	printf("these should all be refused:\n");
+	if(generateGrid(0, 4).getVertexCount() != 0 || generateUVSphere(2, 2).getVertexCount() != 0 || generateIcosphere(0).getVertexCount() != 0
+		|| generateTorus(8, 8, 0.75f).getVertexCount() != 0 || generateCylinder(8, 0).getVertexCount() != 0){
+		fail("bad parameters", "made a mesh");
+	}
+	if(failures > 0){
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("every shape holds up\n");
+	return 0;
+}
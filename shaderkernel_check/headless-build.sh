@@ -0,0 +1 @@
+ g++ -std=c++14 -O2 -DGLM_FORCE_PURE -I ../infrastructure ../infrastructure/shaderkernel.cpp ../infrastructure/shaderpreprocessor.cpp ../infrastructure/embeddedshaders.cpp ../infrastructure/fileview.cpp shaderkernel_check.cpp -o shaderkernel_check && ./shaderkernel_check
@@ -0,0 +1,248 @@
+/***************************************************************************
+Copyright (c) 2015 John Dickinson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "shaderkernel.h"
+#include "glm/glm.hpp"
+#include "glm/ext.hpp"
+
+/*
+Shader Kernel Check
+*************************
+Runs advanced_lighting's lighting.frag (the metal and the dielectric permutation) and the shared
+mvpNormals.vert (with and without DRAW_DATA) through ShaderKernel, and compares every output with
+the same math written with glm, over a spread of normals, positions, materials and roughness values.
+It also checks that shaders using GLSL the kernel doesn't understand are turned away.
+Exits with 1 if anything is further than the tolerance from the reference, so the BRDF can be
+regression tested on machines without a GPU. Run it from this folder.
+*/
+
+using namespace glm;
+
+namespace {
+//the kernel runs the same float operations as the reference, so only the order of a few
+//	library calls (normalize, inverse) separates them
+const float Tolerance = 1e-4f;
+
+int failures = 0;
+
+void expectNear(const char* what, const float* got, const float* expected, int components, float scale = 1.f){
+	for(int c=0;c<components;c++){
+		float error = std::abs(got[c] - expected[c]);
+		if(!(error <= Tolerance * std::max(scale, 1.f))){
+			if(failures < 20){
+				printf("%s[%d] is %g, expected %g\n", what, c, got[c], expected[c]);
+			}
+			failures++;
+		}
+	}
+}
+
+//a fixed sequence so every run checks the same cases
+float next(unsigned int& state){
+	state = state * 1664525u + 1013904223u;
+	return float(state >> 8) / float(1 << 24);
+}
+
+vec3 randomDirection(unsigned int& state){
+	vec3 direction;
+	do {
+		direction = vec3(next(state), next(state), next(state)) * 2.f - 1.f;
+	} while(length(direction) < 0.1f || length(direction) > 1.f);
+	return normalize(direction);
+}
+
+//lighting.frag written with glm, line for line
+const float pi = 3.14159265f;
+
+vec3 specular(vec3 lightDir, vec3 normal, vec3 viewDir, vec3 specularRGB, float roughness){
+	vec3 halfVec = normalize(lightDir + viewDir);
+	float microfacet = ((roughness + 2.f) / (2.f * pi)) * pow(max(dot(normal, halfVec), 0.f), roughness);
+	vec3 fresnel = specularRGB + (1.f - specularRGB) * pow(1.f - dot(lightDir, halfVec), 5.f);
+	float denom = dot(lightDir, halfVec);
+	float geometry = 1.f / (denom * denom);
+	return 0.25f * geometry * microfacet * fresnel;
+}
+
+struct Frame {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec3 cameraWorldPosition;
+	vec3 lightPosition;
+	vec3 lightColor;
+};
+
+vec4 lighting(const Frame& frame, vec3 materialColor, float metalness, float roughness, vec3 worldNormal, vec3 worldPosition){
+	vec3 normal = normalize(worldNormal);
+	vec3 lightdiff = frame.lightPosition - worldPosition;
+	vec3 lightDirection = normalize(lightdiff);
+	float lightDistance = length(lightdiff);
+	vec3 eyeDirection = normalize(frame.cameraWorldPosition - worldPosition);
+	vec3 diffuse = mix(materialColor, vec3(0.f), metalness);
+	vec3 specColor = mix(vec3(0.04f), materialColor, metalness);
+	float mappedRough = pow(100000.f, roughness);
+	float lightNumerator = min(1.f - pow(lightDistance / 1000.f, 4.f), 1.f);
+	float falloff = (lightNumerator * lightNumerator) / ((lightDistance * lightDistance) + 1.f);
+	vec3 light = falloff * frame.lightColor * max(dot(normal, lightDirection), 0.f) * (diffuse + specular(lightDirection, normal, eyeDirection, specColor, mappedRough));
+	vec3 skyDir(0.f, 1.f, 0.f);
+	light += frame.lightColor * 0.001f * max(dot(normal, skyDir), 0.f) * (diffuse + specular(skyDir, skyDir, skyDir, specColor, mappedRough));
+	return vec4(light / (light + 1.f), 1.f);
+}
+
+void setFrame(ShaderKernel& kernel, const Frame& frame){
+	kernel.setUniform("projectionMatrix", frame.projectionMatrix);
+	kernel.setUniform("viewMatrix", frame.viewMatrix);
+	kernel.setUniform("cameraWorldPosition", frame.cameraWorldPosition);
+	kernel.setUniform("lightPosition", frame.lightPosition);
+	kernel.setUniform("lightColor", frame.lightColor);
+}
+
+void checkLighting(const Frame& frame, const char* metalness){
+	std::unique_ptr<ShaderKernel> kernel = ShaderKernel::CreateFromFile("../advanced_lighting/lighting.frag", ShaderDefines{{"METALNESS", metalness}});
+	if(!kernel){
+		failures++;
+		return;
+	}
+	setFrame(*kernel, frame);
+	float metal = float(atof(metalness));
+	const float roughnesses[] = {0.f, 0.1f, 0.25f, 0.5f, 0.8f, 1.f};
+	const vec3 colors[] = {vec3(1.0f, 0.766f, 0.336f), vec3(0.14f, 0.54f, 0.96f), vec3(0.5f), vec3(1.f)};
+	unsigned int state = 1;
+	int cases = 0;
+	for(float roughness : roughnesses){
+		for(const vec3& color : colors){
+			kernel->setUniform("roughness", roughness);
+			kernel->setUniform("materialColor", color);
+			//the block's own metalness is ignored when METALNESS is defined, a wrong value shows if it isn't
+			kernel->setUniform("metalness", 0.5f);
+			for(int batch=0;batch<8;batch++){
+				vec3 normals[ShaderKernel::Lanes], positions[ShaderKernel::Lanes];
+				for(int lane=0;lane<ShaderKernel::Lanes;lane++){
+					//interpolated normals aren't unit length, and some face away from the light
+					normals[lane] = randomDirection(state) * (0.8f + 0.4f * next(state));
+					positions[lane] = (vec3(next(state), next(state), next(state)) * 2.f - 1.f) * 2.f;
+					kernel->setInput("vs_WorldNormal", lane, normals[lane]);
+					kernel->setInput("vs_WorldPosition", lane, positions[lane]);
+				}
+				kernel->run();
+				for(int lane=0;lane<ShaderKernel::Lanes;lane++){
+					vec4 got = kernel->getOutput<vec4>("fragColor", lane);
+					vec4 expected = lighting(frame, color, metal, roughness, normals[lane], positions[lane]);
+					expectNear("fragColor", value_ptr(got), value_ptr(expected), 4);
+					cases++;
+				}
+			}
+		}
+	}
+	printf("lighting.frag with METALNESS %s: %d fragments\n", metalness, cases);
+}
+
+void checkVertex(const Frame& frame, bool drawData){
+	ShaderDefines defines;
+	if(drawData){
+		defines["DRAW_DATA"] = "1";
+	}
+	std::unique_ptr<ShaderKernel> kernel = ShaderKernel::CreateFromFile("../shaders/mvpNormals.vert", defines);
+	if(!kernel){
+		failures++;
+		return;
+	}
+	setFrame(*kernel, frame);
+	unsigned int state = 2;
+	int cases = 0;
+	for(int model=0;model<16;model++){
+		mat4 modelMatrix = translate(vec3(next(state), next(state), next(state)) * 4.f - 2.f)
+			* rotate(next(state) * 360.f, randomDirection(state))
+			* scale(vec3(0.5f) + vec3(next(state), next(state), next(state)) * 2.f);
+		kernel->setUniform("modelMatrix", modelMatrix);
+		vec3 positions[ShaderKernel::Lanes], normals[ShaderKernel::Lanes];
+		for(int lane=0;lane<ShaderKernel::Lanes;lane++){
+			positions[lane] = vec3(next(state), next(state), next(state)) * 2.f - 1.f;
+			normals[lane] = randomDirection(state);
+			kernel->setInput("in_Position", lane, positions[lane]);
+			kernel->setInput("in_Normal", lane, normals[lane]);
+		}
+		kernel->run();
+		for(int lane=0;lane<ShaderKernel::Lanes;lane++){
+			vec4 worldPosition = modelMatrix * vec4(positions[lane], 1.f);
+			mat4 normalMatrix = transpose(inverse(modelMatrix));
+			vec3 worldNormal = vec3(normalize(normalMatrix * vec4(normals[lane], 0.f)));
+			vec3 world = vec3(worldPosition);
+			vec3 eye = normalize(frame.cameraWorldPosition - world);
+			vec3 light = normalize(frame.lightPosition - world);
+			float distance = length(frame.lightPosition - world);
+			vec4 clip = frame.projectionMatrix * frame.viewMatrix * worldPosition;
+			//positions are compared relative to their size
+			expectNear("gl_Position", value_ptr(kernel->getOutput<vec4>("gl_Position", lane)), value_ptr(clip), 4, length(clip));
+			expectNear("vs_WorldPosition", value_ptr(kernel->getOutput<vec3>("vs_WorldPosition", lane)), value_ptr(world), 3, length(world));
+			expectNear("vs_WorldNormal", value_ptr(kernel->getOutput<vec3>("vs_WorldNormal", lane)), value_ptr(worldNormal), 3);
+			expectNear("vs_EyeVector", value_ptr(kernel->getOutput<vec3>("vs_EyeVector", lane)), value_ptr(eye), 3);
+			expectNear("vs_LightVector", value_ptr(kernel->getOutput<vec3>("vs_LightVector", lane)), value_ptr(light), 3);
+			float gotDistance = kernel->getOutput<float>("vs_LightDistance", lane);
+			expectNear("vs_LightDistance", &gotDistance, &distance, 1, distance);
+			cases++;
+		}
+	}
+	printf("mvpNormals.vert%s: %d vertices\n", drawData ? " with DRAW_DATA" : "", cases);
+}
+
+//each of these has to fail to compile rather than run wrong
+void checkRejected(){
+	const char* unsupported[][2] = {
+		{"if", "#version 300 es\nout vec4 color;\nvoid main(){\n\tif(true) color = vec4(1.0);\n}\n"},
+		{"for", "#version 300 es\nout vec4 color;\nvoid main(){\n\tcolor = vec4(0.0);\n\tfor(int i=0;i<4;i++) color += vec4(0.25);\n}\n"},
+		{"sampler", "#version 300 es\nuniform sampler2D image;\nin vec2 uv;\nout vec4 color;\nvoid main(){\n\tcolor = texture(image, uv);\n}\n"},
+		{"array", "#version 300 es\nuniform vec4 colors[4];\nout vec4 color;\nvoid main(){\n\tcolor = colors[1];\n}\n"},
+		{"narrowing", "#version 300 es\nout vec2 color;\nvoid main(){\n\tvec3 a = vec3(1.0);\n\tcolor = a;\n}\n"},
+		{"undeclared", "#version 300 es\nout vec4 color;\nvoid main(){\n\tcolor = missing;\n}\n"}
+	};
+	printf("the kernel should reject each of these:\n");
+	for(auto& shader : unsupported){
+		if(ShaderKernel::Create(shader[1], shader[0])){
+			printf("%s compiled\n", shader[0]);
+			failures++;
+		}
+	}
+}
+}
+
+int main(){
+	Frame frame;
+	frame.projectionMatrix = perspective(60.f, 800.f / 600.f, 0.1f, 100.f);
+	frame.cameraWorldPosition = vec3(0.f, 2.f, 3.f);
+	frame.viewMatrix = lookAt(frame.cameraWorldPosition, vec3(0.f, 2.f, 0.f), vec3(0.f, 1.f, 0.f));
+	frame.lightPosition = vec3(1.f, 2.f, -2.f);
+	frame.lightColor = vec3(20.f);
+	checkLighting(frame, "1.0");
+	checkLighting(frame, "0.0");
+	checkVertex(frame, false);
+	checkVertex(frame, true);
+	checkRejected();
+	if(failures > 0){
+		printf("%d values differ from the reference by more than %g\n", failures, Tolerance);
+		return 1;
+	}
+	printf("everything matches the reference\n");
+	return 0;
+}
@@ -0,0 +1,8 @@
+//per draw values streamed by the RenderQueue, see RenderQueue::streamDrawData
+//	the members after the model matrix are advanced_lighting's MaterialData
+layout(std140) uniform DrawData {
+    mat4 modelMatrix;
+    vec3 materialColor;
+    float metalness;
+    float roughness;
+};
@@ -0,0 +1,8 @@
+//per frame values shared by every program, see FrameUniforms in uniformbuffer.h
+layout(std140) uniform FrameData {
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    vec3 cameraWorldPosition;
+    vec3 lightPosition;
+    vec3 lightColor;
+};
@@ -10,11 +10,16 @@ out vec3 vs_EyeVector;
 out vec3 vs_LightVector;
 out float vs_LightDistance;
 
+//streamed per draw by a RenderQueue (see streamDrawData) when DRAW_DATA is defined, a plain uniform otherwise
+#ifdef DRAW_DATA
+#include "drawdata.glsl"
+#else
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
-uniform vec3 cameraWorldPosition;
-uniform vec3 lightPosition;
+#endif
+#include "framedata.glsl"
+
+//cube_field's depth.vert has to match this bit for the depth prepass
+invariant gl_Position;
 
 void main(void){
     mat4 normalMatrix = transpose(inverse(modelMatrix));